@@ -0,0 +1,143 @@
+//
+//    Copyright (C) 2026 Holger Teutsch
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 2.1 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+//    USA
+//
+
+// Micro-benchmark of Ofp::GenDepartureStr(), links against xplm_stub, see README for the build.
+//
+// ./bench_departure_str [iterations]
+//
+// Compares time and heap allocations per call of the former std::string concatenation
+// (atol + gmtime + strftime), GenDepartureStr(buf, size), GenDepartureStr() and
+// DepartureStrCache. First checks that all of them produce the same string,
+// including unix times with leading blanks, signs and garbage.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <new>
+
+#include "simbrief.h"
+
+const char *log_msg_prefix = "bench: ";
+
+static size_t n_alloc;
+
+void *operator new(size_t size) {
+    n_alloc++;
+    if (void *p = malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+// the implementation before the buffer version
+static std::string LegacyDepartureStr(const Ofp& ofp) {
+    std::string str;
+    str = ofp.icao_airline + ofp.flight_number + " " + ofp.aircraft_icao + " TO " + ofp.destination;
+
+    time_t out_time = atol(ofp.est_out.c_str());
+    time_t off_time = atol(ofp.est_off.c_str());
+
+    if (ofp.cdm_tobt.empty()) {
+        auto out_tm = *std::gmtime(&out_time);
+        auto off_tm = *std::gmtime(&off_time);
+        char out[40];
+        strftime(out, sizeof(out), " OUT %H%M", &out_tm);
+        str.append(out);
+        strftime(out, sizeof(out), " OFF %H%M", &off_tm);
+        str.append(out);
+    } else {
+        if (ofp.cdm_tsat != ofp.cdm_tobt)
+            str.append(" TOBT " + ofp.cdm_tobt);
+        if (!ofp.cdm_tsat.empty())
+            str.append(" TSAT " + ofp.cdm_tsat);
+        if (!ofp.cdm_ctot.empty())
+            str.append(" CTOT " + ofp.cdm_ctot);
+    }
+
+    if (!ofp.cdm_runway.empty())
+        str.append(" RWY " + ofp.cdm_runway);
+    if (!ofp.cdm_sid.empty())
+        str.append(" SID " + ofp.cdm_sid);
+
+    return str;
+}
+
+template <typename F>
+static void Bench(const char *name, int n, F&& f) {
+    size_t a0 = n_alloc;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++)
+        f(i);
+    std::chrono::duration<double, std::nano> dt = std::chrono::steady_clock::now() - t0;
+    printf("%-34s %8.1f ns  %5.2f allocs\n", name, dt.count() / n, double(n_alloc - a0) / n);
+}
+
+int main(int argc, char **argv) {
+    int n = (argc > 1) ? atoi(argv[1]) : 2000000;
+    int failed = 0;
+
+    Ofp ofp;
+    ofp.icao_airline = "DLH";
+    ofp.flight_number = "456";
+    ofp.aircraft_icao = "A20N";
+    ofp.destination = "EDDM";
+    ofp.cdm_runway = "25C";
+    ofp.cdm_sid = "MARUN7F";
+
+    static const char *times[] = {"1700000000", " 1700000000", "\t+1700000000", "-1", "-86401", "0", "",
+                                  "abc", "1700000000xyz", "  -1700000000", "99999999999"};
+    for (const char *out : times) {
+        ofp.est_out = out;
+        ofp.est_off = times[0];
+        std::string ref = LegacyDepartureStr(ofp), str = ofp.GenDepartureStr();
+        if (ref != str) {
+            printf("MISMATCH est_out '%s':\n  '%s'\n  '%s'\n", out, ref.c_str(), str.c_str());
+            failed++;
+        }
+    }
+
+    ofp.cdm_tobt = "1155";
+    ofp.cdm_tsat = "1200";
+    if (LegacyDepartureStr(ofp) != ofp.GenDepartureStr()) {
+        printf("MISMATCH cdm\n");
+        failed++;
+    }
+
+    // the common case without CDM
+    ofp.est_out = "1700000000";
+    ofp.est_off = "1700001200";
+    ofp.cdm_tobt = ofp.cdm_tsat = "";
+    ofp.seqno = 1;
+
+    size_t len = 0;
+    char buf[128];
+    DepartureStrCache cache;
+
+    printf("%d iterations, '%s'\n", n, ofp.GenDepartureStr().c_str());
+    Bench("std::string concat (before)", n, [&](int) { len += LegacyDepartureStr(ofp).size(); });
+    Bench("GenDepartureStr()", n, [&](int) { len += ofp.GenDepartureStr().size(); });
+    Bench("GenDepartureStr(buf, size)", n, [&](int) { len += ofp.GenDepartureStr(buf, sizeof(buf)); });
+    Bench("DepartureStrCache::Get", n, [&](int) { len += cache.Get(ofp)[0]; });
+
+    printf("%s (%zu)\n", failed ? "FAILED" : "OK", len);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,145 @@
+//
+//    Copyright (C) 2026 Holger Teutsch
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 2.1 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+//    USA
+//
+
+// Standalone check and benchmark of flat_earth_batch.h, build with e.g.
+//   c++ -std=c++20 -O2 -o bench_flat_earth_batch bench_flat_earth_batch.cpp
+//   c++ -std=c++20 -O2 -mavx -o bench_flat_earth_batch bench_flat_earth_batch.cpp
+//   c++ -std=c++20 -O2 -DFLAT_EARTH_NO_SIMD -o bench_flat_earth_batch bench_flat_earth_batch.cpp
+//
+// ./bench_flat_earth_batch [n_positions] [rounds]
+//
+// Checks that the batch functions are bit-identical to the scalar operator-, len() and
+// operator*, for origins at all latitudes, across the antimeridian and for any batch size.
+// Then times them against the scalar loops.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "flat_earth_batch.h"
+
+using namespace flat_earth_math;
+
+static int failed;
+
+static void Check(const char *what, const LLPos& a, const double *res, const double *ref, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (memcmp(&res[i], &ref[i], sizeof(double))) {
+            printf("MISMATCH %s origin (%.6f, %.6f), i: %zu: %.17g != %.17g\n", what, a.lat, a.lon, i, res[i], ref[i]);
+            failed++;
+            return;
+        }
+    }
+}
+
+template <typename F>
+static double NsPerPos(size_t n, int rounds, F&& f) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++)
+        f();
+    std::chrono::duration<double, std::nano> dt = std::chrono::steady_clock::now() - t0;
+    return dt.count() / (double(n) * rounds);
+}
+
+int main(int argc, char **argv) {
+    size_t n = (argc > 1) ? atol(argv[1]) : 1000;
+    int rounds = (argc > 2) ? atoi(argv[2]) : 20000;
+
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> u(-1.0, 1.0);
+
+    // correctness, sizes that leave a scalar tail
+    const Vec2 v{0.6, -0.8};
+    for (int k = 0; k < 2000; k++) {
+        LLPos a(89.0 * u(rng), 180.0 * u(rng));
+        size_t m = k % 37;
+        std::vector<double> lat(m), lon(m), x(m), y(m), d(m), dot(m);
+        std::vector<double> rx(m), ry(m), rd(m), rdot(m);
+        double spread = (k % 2) ? 0.05 : 5.0;
+        for (size_t i = 0; i < m; i++) {
+            lat[i] = std::clamp(a.lat + spread * u(rng), -90.0, 90.0);
+            lon[i] = RA(a.lon + spread * u(rng));
+            Vec2 r = LLPos(lat[i], lon[i]) - a;
+            rx[i] = r.x;
+            ry[i] = r.y;
+            rd[i] = len(r);
+            rdot[i] = r * v;
+        }
+
+        BatchDiff(a, lat.data(), lon.data(), m, x.data(), y.data());
+        BatchDist(a, lat.data(), lon.data(), m, d.data());
+        BatchDot(a, lat.data(), lon.data(), m, v, dot.data());
+        Check("BatchDiff x", a, x.data(), rx.data(), m);
+        Check("BatchDiff y", a, y.data(), ry.data(), m);
+        Check("BatchDist", a, d.data(), rd.data(), m);
+        Check("BatchDot", a, dot.data(), rdot.data(), m);
+    }
+
+    // timing, stands of an airport around the aircraft
+    LLPos a(48.3538, 11.7861);
+    std::vector<double> lat(n), lon(n), x(n), y(n), d(n);
+    std::vector<LLPos> pos(n);
+    for (size_t i = 0; i < n; i++) {
+        lat[i] = a.lat + 0.02 * u(rng);
+        lon[i] = a.lon + 0.03 * u(rng);
+        pos[i] = LLPos(lat[i], lon[i]);
+    }
+
+    double sum = 0.0;
+    double t_dist_s = NsPerPos(n, rounds, [&] {
+        for (size_t i = 0; i < n; i++)
+            d[i] = len(pos[i] - a);
+        sum += d[n / 2];
+    });
+
+    double t_dist_b = NsPerPos(n, rounds, [&] {
+        BatchDist(a, lat.data(), lon.data(), n, d.data());
+        sum += d[n / 2];
+    });
+
+    double t_diff_s = NsPerPos(n, rounds, [&] {
+        for (size_t i = 0; i < n; i++) {
+            Vec2 r = pos[i] - a;
+            x[i] = r.x;
+            y[i] = r.y;
+        }
+        sum += x[n / 2];
+    });
+
+    double t_diff_b = NsPerPos(n, rounds, [&] {
+        BatchDiff(a, lat.data(), lon.data(), n, x.data(), y.data());
+        sum += x[n / 2];
+    });
+
+#ifdef FLAT_EARTH_SIMD
+    const char *mode = "SIMD";
+#else
+    const char *mode = "scalar";
+#endif
+
+    printf("%s, %zu positions x %d rounds, ns per position\n", mode, n, rounds);
+    printf("len(pos - a) loop   %6.2f   BatchDist %6.2f\n", t_dist_s, t_dist_b);
+    printf("pos - a loop        %6.2f   BatchDiff %6.2f\n", t_diff_s, t_diff_b);
+    printf("%s (%g)\n", failed ? "FAILED" : "OK", sum);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,180 @@
+//
+//    Copyright (C) 2026 Holger Teutsch
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 2.1 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+//    USA
+//
+
+// Check and benchmark of OfpXmlParser, links against xplm_stub, see README for the build.
+//
+// ./bench_ofp_xml [fixtures_dir] [navlog_fixes]
+//
+// Parses the OFPs in fixtures/ fed in one piece, byte by byte and split at every
+// position, and compares the fields. ofp_markup.xml has comments, CDATA, PIs and
+// '>' in attribute values. Then times the parse of a SimBrief sized OFP (a navlog of
+// navlog_fixes fixes in front of the wanted weights and times) fed in 16 kB chunks
+// as by libcurl and reports time, throughput and peak heap.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+
+#include "simbrief.h"
+
+const char *log_msg_prefix = "bench: ";
+
+// heap use, the size is kept in front of each block
+static size_t n_alloc, cur_bytes, peak_bytes;
+static constexpr size_t kHdr = alignof(std::max_align_t);
+
+void *operator new(size_t size) {
+    char *p = (char *)malloc(size + kHdr);
+    if (p == nullptr)
+        throw std::bad_alloc();
+    *(size_t *)p = size;
+    n_alloc++;
+    cur_bytes += size;
+    peak_bytes = std::max(peak_bytes, cur_bytes);
+    return p + kHdr;
+}
+
+void operator delete(void *p) noexcept {
+    if (p == nullptr)
+        return;
+    char *b = (char *)p - kHdr;
+    cur_bytes -= *(size_t *)b;
+    free(b);
+}
+
+void operator delete(void *p, size_t) noexcept { operator delete(p); }
+
+static int failed;
+
+static std::string ReadFile(const std::string& path) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) {
+        printf("can't read '%s'\n", path.c_str());
+        exit(1);
+    }
+
+    std::stringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+}
+
+static void Expect(const char *what, const std::string& is, const char *expected) {
+    if (is != expected) {
+        printf("  %s: '%s', expected '%s'\n", what, is.c_str(), expected);
+        failed++;
+    }
+}
+
+// parse xml fed in pieces of chunk bytes, or split once at split if chunk is 0
+static Ofp Parse(const std::string& xml, size_t chunk, size_t split = 0) {
+    Ofp ofp;
+    OfpXmlParser parser(ofp);
+    if (chunk == 0) {
+        parser.Feed(xml.data(), split);
+        parser.Feed(xml.data() + split, xml.size() - split);
+    } else {
+        for (size_t i = 0; i < xml.size(); i += chunk)
+            parser.Feed(xml.data() + i, std::min(chunk, xml.size() - i));
+    }
+
+    if (!parser.Done()) {
+        printf("  not all fields found\n");
+        failed++;
+    }
+
+    return ofp;
+}
+
+static void Check(const char *dx_rmk, const Ofp& ofp) {
+    Expect("icao_airline", ofp.icao_airline, "DLH");
+    Expect("flight_number", ofp.flight_number, "456");
+    Expect("aircraft_icao", ofp.aircraft_icao, "A20N");
+    Expect("destination", ofp.destination, "EDDM");
+    Expect("pax_count", ofp.pax_count, "174");
+    Expect("freight", ofp.freight, "1200");
+    Expect("est_out", ofp.est_out, "1700000000");
+    Expect("est_off", ofp.est_off, "1700001200");
+    Expect("est_on", ofp.est_on, "1700004800");
+    Expect("est_in", ofp.est_in, "1700005400");
+    Expect("dx_rmk", ofp.dx_rmk, dx_rmk);
+}
+
+static void Fixture(const std::string& path, const char *dx_rmk) {
+    printf("%s\n", path.c_str());
+    std::string xml = ReadFile(path);
+    int f0 = failed;
+
+    Check(dx_rmk, Parse(xml, xml.size()));
+    Check(dx_rmk, Parse(xml, 1));
+    for (size_t split = 0; split <= xml.size() && failed == f0; split++)
+        Check(dx_rmk, Parse(xml, 0, split));
+
+    if (failed > f0)
+        printf("  FAILED\n");
+}
+
+int main(int argc, char **argv) {
+    std::string dir = (argc > 1) ? argv[1] : "fixtures";
+    int n_fixes = (argc > 2) ? atoi(argv[2]) : 3000;
+
+    Fixture(dir + "/ofp_plain.xml", "RMK/TCAS");
+    Fixture(dir + "/ofp_markup.xml", "RMK/A&B <x> ]]] &lt; & C");
+
+    // a SimBrief sized OFP, the navlog comes before weights and times
+    std::string xml = ReadFile(dir + "/ofp_plain.xml");
+    std::string navlog = "<navlog>\n";
+    for (int i = 0; i < n_fixes; i++) {
+        char fix[512];
+        snprintf(fix, sizeof(fix),
+                 "    <fix>\n      <ident>F%04d</ident>\n      <name>FIX %d</name>\n      <type>wpt</type>\n"
+                 "      <pos_lat>%.6f</pos_lat>\n      <pos_long>%.6f</pos_long>\n      <altitude_feet>%d</altitude_feet>\n"
+                 "      <wind_data><level><altitude>%d</altitude><wind_dir>270</wind_dir><wind_spd>35</wind_spd></level></wind_data>\n"
+                 "    </fix>\n",
+                 i, i, 50.0 + i * 0.001, 8.5 + i * 0.001, 35000, 35000);
+        navlog += fix;
+    }
+    navlog += "  </navlog>\n  ";
+    xml.insert(xml.find("<weights>"), navlog);
+
+    constexpr size_t kChunk = 16384;
+    int rounds = std::max(1, int(200000000 / xml.size()));
+    size_t a0 = n_alloc;
+    peak_bytes = cur_bytes;
+    size_t base = cur_bytes;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++)
+        Check("RMK/TCAS", Parse(xml, kChunk));
+    double dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() / rounds;
+
+    printf("\n%zu kB OFP in %zu kB chunks, %d rounds\n", xml.size() / 1024, kChunk / 1024, rounds);
+    printf("parse time   %8.3f ms\n", dt * 1000.0);
+    printf("throughput   %8.1f MB/s\n", xml.size() / dt / 1.0E6);
+    printf("peak heap    %8zu bytes\n", peak_bytes - base);
+    printf("allocations  %8.1f per parse\n", double(n_alloc - a0) / rounds);
+
+    printf("%s\n", failed ? "FAILED" : "OK");
+    return failed ? 1 : 0;
+}
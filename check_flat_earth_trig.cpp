@@ -0,0 +1,193 @@
+//
+//    Copyright (C) 2026 Holger Teutsch
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 2.1 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+//    USA
+//
+
+// Standalone accuracy check and benchmark of flat_earth_trig.h, build with e.g.
+//   c++ -std=c++20 -O2 -o check_flat_earth_trig check_flat_earth_trig.cpp
+//
+// ./check_flat_earth_trig [samples] [-exhaustive]
+//
+// Measures the max absolute error against long double libm with random double arguments
+// (default 2e7) and checks it against the table in flat_earth_trig.h. With -exhaustive
+// Sin(float) is checked for all floats in [-720°, 720°] as for the table, that takes
+// a couple of minutes, otherwise with the same number of random floats.
+// Also checks the ranges of RAFast, Atan2 and Bearing. Then times the functions against libm.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "flat_earth_trig.h"
+
+using namespace flat_earth_math;
+
+static constexpr long double kPi = 3.141592653589793238462643383279502884L;
+
+static int failed;
+
+// the documented bounds, rounded to 2 digits there, hence the slack
+struct Bounds {
+    double sin, sin_float, atan2;
+};
+
+static void Verify(const char *what, long double err, double bound) {
+    bool ok = err <= bound * 1.05;
+    printf("  %-12s %9.2Le  (%.1e)%s\n", what, err, bound, ok ? "" : "  EXCEEDS");
+    failed += !ok;
+}
+
+template <TrigAccuracy A>
+static void Accuracy(const char *tier, const Bounds& b, long samples, bool exhaustive) {
+    std::mt19937_64 rng(1);
+    std::uniform_real_distribution<double> deg(-720.0, 720.0), u(-1.0, 1.0);
+    long double e_sin = 0, e_cos = 0, e_atan2 = 0, e_float = 0;
+
+    for (long i = 0; i < samples; i++) {
+        double d = deg(rng);
+        long double rad = d * (kPi / 180);
+        e_sin = std::max(e_sin, fabsl(Sin<A>(d) - sinl(rad)));
+        e_cos = std::max(e_cos, fabsl(Cos<A>(d) - cosl(rad)));
+
+        double y = u(rng), x = u(rng);
+        long double e = fabsl(Atan2<A>(y, x) - atan2l(y, x) * (180 / kPi));
+        e_atan2 = std::max(e_atan2, e > 180 ? 360 - e : e);  // +-180
+
+        double br = Bearing<A>(Vec2{x, y});
+        if (!(br >= 0.0 && br < 360.0)) {
+            printf("  Bearing(%g, %g) = %g out of [0, 360)\n", x, y, br);
+            failed++;
+        }
+    }
+
+    auto sin_float = [&](float f) {
+        e_float = std::max(e_float, fabsl(Sin<A>(f) - sinl(f * (kPi / 180))));
+    };
+
+    if (exhaustive) {
+        for (float f = -720.0f; f <= 720.0f; f = nextafterf(f, 1000.0f))
+            sin_float(f);
+    } else {
+        for (long i = 0; i < samples; i++)
+            sin_float((float)deg(rng));
+    }
+
+    printf("%s\n", tier);
+    Verify("Sin", e_sin, b.sin);
+    Verify("Cos", e_cos, b.sin);
+    Verify("Sin(float)", e_float, b.sin_float);
+    Verify("Atan2 deg", e_atan2, b.atan2);
+}
+
+static void Ranges() {
+    std::vector<double> args;
+    for (double k = -2.0; k <= 2.0; k++)
+        for (double a : {-180.0, 180.0}) {
+            double x = a + k * 360.0;
+            args.insert(args.end(), {x, nextafter(x, -1000.0), nextafter(x, 1000.0)});
+        }
+
+    for (double a : args) {
+        double r = RAFast(a);
+        float rf = RAFast((float)a);
+        if (!(r > -180.0 && r <= 180.0) || !(rf > -180.0f && rf <= 180.0f)) {
+            printf("RAFast(%.17g) = %.17g, %.9g out of (-180, 180]\n", a, r, rf);
+            failed++;
+        }
+    }
+
+    if (Atan2(0.0, 0.0) != 0.0 || Atan2<kTrigHigh>(0.0, -1.0) != 180.0) {
+        printf("Atan2(0, 0) = %g, Atan2(0, -1) = %g\n", Atan2(0.0, 0.0), Atan2<kTrigHigh>(0.0, -1.0));
+        failed++;
+    }
+
+    double b = Bearing(Vec2{-1.0E-300, 1.0});    // b + 360 rounds to 360
+    if (!(b >= 0.0 && b < 360.0)) {
+        printf("Bearing(-1e-300, 1) = %.17g out of [0, 360)\n", b);
+        failed++;
+    }
+}
+
+template <typename F>
+static double NsPerCall(size_t n, F&& f) {
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double, std::nano> dt = std::chrono::steady_clock::now() - t0;
+    return dt.count() / n;
+}
+
+static void Bench() {
+    constexpr size_t n = 1 << 20;
+    constexpr int rounds = 50;
+    std::vector<double> a(n), o(n);
+    std::vector<float> af(n);
+    for (size_t i = 0; i < n; i++) {
+        a[i] = fmod(i * 0.37, 1440.0) - 720.0;
+        af[i] = (float)a[i];
+    }
+
+    double sum = 0.0;
+    auto run = [&](const char *name, auto f) {
+        double t = NsPerCall(n * rounds, [&] {
+            for (int r = 0; r < rounds; r++)
+                for (size_t i = 0; i < n; i++)
+                    o[i] = f(i);
+            sum += o[n / 2];
+        });
+        printf("  %-28s %6.2f ns\n", name, t);
+    };
+
+    printf("\nns per call, %zu arguments x %d\n", n, rounds);
+    run("libm cos(double)", [&](size_t i) { return cos(a[i] * 0.017453292519943295); });
+    run("Cos<kTrigLow>(double)", [&](size_t i) { return Cos<kTrigLow>(a[i]); });
+    run("Cos<kTrigMedium>(double)", [&](size_t i) { return Cos<kTrigMedium>(a[i]); });
+    run("Cos<kTrigHigh>(double)", [&](size_t i) { return Cos<kTrigHigh>(a[i]); });
+    run("libm cosf(float)", [&](size_t i) { return (double)cosf(af[i] * 0.017453292f); });
+    run("Cos<kTrigMedium>(float)", [&](size_t i) { return (double)Cos<kTrigMedium>(af[i]); });
+    run("libm atan2(double)", [&](size_t i) { return atan2(a[i], a[n - 1 - i]) * 57.295779513082323; });
+    run("Atan2<kTrigMedium>(double)", [&](size_t i) { return Atan2<kTrigMedium>(a[i], a[n - 1 - i]); });
+    run("Atan2<kTrigHigh>(double)", [&](size_t i) { return Atan2<kTrigHigh>(a[i], a[n - 1 - i]); });
+    run("RA(double)", [&](size_t i) { return RA(a[i]); });
+    run("RAFast(double)", [&](size_t i) { return RAFast(a[i]); });
+    printf("  (%g)\n", sum);
+}
+
+int main(int argc, char **argv) {
+    long samples = 20000000;
+    bool exhaustive = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-exhaustive") == 0)
+            exhaustive = true;
+        else
+            samples = atol(argv[i]);
+    }
+
+    printf("max abs error, %ld samples%s (documented bound)\n", samples, exhaustive ? ", Sin(float) exhaustive" : "");
+    Accuracy<kTrigLow>("kTrigLow", {1.4e-4, 1.4e-4, 3.9e-4}, samples, exhaustive);
+    Accuracy<kTrigMedium>("kTrigMedium", {1.2e-6, 1.4e-6, 1.2e-5}, samples, exhaustive);
+    Accuracy<kTrigHigh>("kTrigHigh", {1.2e-15, 1.7e-7, 5.2e-14}, samples, exhaustive);
+    Ranges();
+    Bench();
+
+    printf("%s\n", failed ? "FAILED" : "OK");
+    return failed ? 1 : 0;
+}
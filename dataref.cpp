@@ -0,0 +1,44 @@
+//
+//    Copyright (C) 2026 Holger Teutsch
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 2.1 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+//    USA
+//
+
+#include "dataref.h"
+
+// Values that fit the stack buffer are fetched with a single call.
+bool DrefRead(XPLMDataRef dr, std::string& dst) {
+    static std::string scratch;    // for long values, datarefs are only read from the main thread
+    char buffer[256];
+    const char *val = buffer;
+
+    int n = XPLMGetDatab(dr, buffer, 0, sizeof(buffer));
+    if (n == sizeof(buffer)) {  // may be truncated
+        n = XPLMGetDatab(dr, nullptr, 0, 0);
+        scratch.resize(n);
+        n = XPLMGetDatab(dr, (void*)scratch.data(), 0, n);
+        val = scratch.data();
+    }
+
+    // in case a 0-terminated string was returned
+    n = strnlen(val, n);
+
+    if (dst.size() == (size_t)n && memcmp(dst.data(), val, n) == 0)
+        return false;
+
+    dst.assign(val, n);
+    return true;
+}
@@ -0,0 +1,151 @@
+//
+//    Copyright (C) 2026 Holger Teutsch
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 2.1 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+//    USA
+//
+
+#ifndef _DATAREF_H_
+#define _DATAREF_H_
+
+// Typed dataref bindings read into a snapshot struct
+//
+// struct Acf {
+//     int on_ground;
+//     double lat, lon;
+//     std::array<float, 8> n1;
+//     std::string tailnum;
+// };
+//
+// static DrefRegistry<Acf> acf_drefs;
+// static Acf acf;
+//
+// acf_drefs.Bind<&Acf::on_ground>("sim/flightmodel/failures/onground_any");
+// ...
+// acf_drefs.Resolve();                 // e.g. in XPluginEnable
+//
+// uint64_t changed = acf_drefs.Read(acf);   // each frame, bit i = i-th binding
+//
+// Supported member types are int, float, double, std::string (byte data)
+// and std::array<int, N> / std::array<float, N>.
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "XPLMDataAccess.h"
+
+#include "log_msg.h"
+
+// read a dataref into dst, return true if the value changed
+static inline bool DrefRead(XPLMDataRef dr, int& dst) {
+    int v = XPLMGetDatai(dr);
+    bool changed = (v != dst);
+    dst = v;
+    return changed;
+}
+
+static inline bool DrefRead(XPLMDataRef dr, float& dst) {
+    float v = XPLMGetDataf(dr);
+    bool changed = (v != dst);
+    dst = v;
+    return changed;
+}
+
+static inline bool DrefRead(XPLMDataRef dr, double& dst) {
+    double v = XPLMGetDatad(dr);
+    bool changed = (v != dst);
+    dst = v;
+    return changed;
+}
+
+template <size_t N>
+static inline bool DrefRead(XPLMDataRef dr, std::array<int, N>& dst) {
+    std::array<int, N> v{};
+    XPLMGetDatavi(dr, v.data(), 0, N);
+    bool changed = (v != dst);
+    dst = v;
+    return changed;
+}
+
+template <size_t N>
+static inline bool DrefRead(XPLMDataRef dr, std::array<float, N>& dst) {
+    std::array<float, N> v{};
+    XPLMGetDatavf(dr, v.data(), 0, N);
+    bool changed = (v != dst);
+    dst = v;
+    return changed;
+}
+
+// byte data, the capacity of dst is reused
+extern bool DrefRead(XPLMDataRef dr, std::string& dst);
+
+template <typename S>
+class DrefRegistry {
+    typedef bool (*ReadFn)(XPLMDataRef dr, S& snap);
+
+    struct Binding {
+        const char *name;
+        XPLMDataRef dr;
+        ReadFn read;
+    };
+
+    std::vector<Binding> bindings_;
+
+  public:
+    // bind dataref name to a member of the snapshot, at most 64 bindings
+    template <auto member>
+    void Bind(const char *name) {
+        if (bindings_.size() >= 64) {
+            LogMsg("too many bindings, '%s' is ignored", name);
+            return;
+        }
+
+        bindings_.push_back({name, nullptr, [](XPLMDataRef dr, S& snap) { return DrefRead(dr, snap.*member); }});
+    }
+
+    // Find all datarefs, returns true if all were found.
+    // Bindings that were not found are skipped by Read().
+    bool Resolve() {
+        bool all = true;
+        for (auto& b : bindings_) {
+            b.dr = XPLMFindDataRef(b.name);
+            if (b.dr == nullptr) {
+                LogDebug("dataref '%s' not found", b.name);
+                all = false;
+            }
+        }
+
+        return all;
+    }
+
+    // read all bindings into snap, return mask of the bindings that changed
+    uint64_t Read(S& snap) const {
+        uint64_t mask = 0;
+        for (size_t i = 0; i < bindings_.size(); i++) {
+            const Binding& b = bindings_[i];
+            if (b.dr && b.read(b.dr, snap))
+                mask |= uint64_t{1} << i;
+        }
+
+        return mask;
+    }
+
+    size_t Size() const { return bindings_.size(); }
+};
+
+#endif
@@ -0,0 +1,231 @@
+//
+//    Copyright (C) 2026 Holger Teutsch
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 2.1 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+//    USA
+//
+
+// Batch versions of flat_earth_math for many positions relative to one origin,
+// e.g. from the aircraft to all stands of an airport.
+//
+// Positions are passed as structure of arrays (separate lat and lon arrays). The cos of
+// the origin's latitude is computed once per batch and the loops are vectorised with
+// AVX, SSE2 or NEON (aarch64) depending on the compiler flags, with a scalar fallback.
+// Define FLAT_EARTH_NO_SIMD to force the scalar code.
+//
+// Longitudes are expected in [-180, 180].
+// The products are evaluated in the order of operator- so results are bit-identical to
+// operator-, len() and operator* of the scalar code, for the SIMD and the scalar path.
+// That holds unless the compiler contracts to FMA, e.g. with -mfma -ffp-contract=fast.
+//
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "flat_earth_math.h"
+
+#if !defined(FLAT_EARTH_NO_SIMD)
+#if defined(__AVX__)
+#include <immintrin.h>
+#define FLAT_EARTH_SIMD 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FLAT_EARTH_SIMD 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define FLAT_EARTH_SIMD 1
+#endif
+#endif
+
+namespace flat_earth_math {
+
+#ifdef FLAT_EARTH_SIMD
+namespace simd {
+
+// masks are kept as vd with all bits set or clear per lane
+#if defined(__AVX__)
+typedef __m256d vd;
+static constexpr size_t kWidth = 4;
+
+static inline vd Set1(double x) { return _mm256_set1_pd(x); }
+static inline vd Load(const double *p) { return _mm256_loadu_pd(p); }
+static inline void Store(double *p, vd v) { _mm256_storeu_pd(p, v); }
+static inline vd Add(vd a, vd b) { return _mm256_add_pd(a, b); }
+static inline vd Sub(vd a, vd b) { return _mm256_sub_pd(a, b); }
+static inline vd Mul(vd a, vd b) { return _mm256_mul_pd(a, b); }
+static inline vd Sqrt(vd a) { return _mm256_sqrt_pd(a); }
+static inline vd Gt(vd a, vd b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+static inline vd Ge(vd a, vd b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+static inline vd Le(vd a, vd b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+static inline vd And(vd a, vd b) { return _mm256_and_pd(a, b); }
+static inline vd Or(vd a, vd b) { return _mm256_or_pd(a, b); }
+static inline vd Xor(vd a, vd b) { return _mm256_xor_pd(a, b); }
+static inline int Mask(vd m) { return _mm256_movemask_pd(m); }
+
+#elif defined(__aarch64__)
+typedef float64x2_t vd;
+static constexpr size_t kWidth = 2;
+
+static inline vd Set1(double x) { return vdupq_n_f64(x); }
+static inline vd Load(const double *p) { return vld1q_f64(p); }
+static inline void Store(double *p, vd v) { vst1q_f64(p, v); }
+static inline vd Add(vd a, vd b) { return vaddq_f64(a, b); }
+static inline vd Sub(vd a, vd b) { return vsubq_f64(a, b); }
+static inline vd Mul(vd a, vd b) { return vmulq_f64(a, b); }
+static inline vd Sqrt(vd a) { return vsqrtq_f64(a); }
+static inline vd Gt(vd a, vd b) { return vreinterpretq_f64_u64(vcgtq_f64(a, b)); }
+static inline vd Ge(vd a, vd b) { return vreinterpretq_f64_u64(vcgeq_f64(a, b)); }
+static inline vd Le(vd a, vd b) { return vreinterpretq_f64_u64(vcleq_f64(a, b)); }
+
+static inline vd And(vd a, vd b) {
+    return vreinterpretq_f64_u64(vandq_u64(vreinterpretq_u64_f64(a), vreinterpretq_u64_f64(b)));
+}
+
+static inline vd Or(vd a, vd b) {
+    return vreinterpretq_f64_u64(vorrq_u64(vreinterpretq_u64_f64(a), vreinterpretq_u64_f64(b)));
+}
+
+static inline vd Xor(vd a, vd b) {
+    return vreinterpretq_f64_u64(veorq_u64(vreinterpretq_u64_f64(a), vreinterpretq_u64_f64(b)));
+}
+
+static inline int Mask(vd m) {
+    uint64x2_t u = vreinterpretq_u64_f64(m);
+    return (int)((vgetq_lane_u64(u, 0) & 1) | ((vgetq_lane_u64(u, 1) & 1) << 1));
+}
+
+#else   // SSE2
+typedef __m128d vd;
+static constexpr size_t kWidth = 2;
+
+static inline vd Set1(double x) { return _mm_set1_pd(x); }
+static inline vd Load(const double *p) { return _mm_loadu_pd(p); }
+static inline void Store(double *p, vd v) { _mm_storeu_pd(p, v); }
+static inline vd Add(vd a, vd b) { return _mm_add_pd(a, b); }
+static inline vd Sub(vd a, vd b) { return _mm_sub_pd(a, b); }
+static inline vd Mul(vd a, vd b) { return _mm_mul_pd(a, b); }
+static inline vd Sqrt(vd a) { return _mm_sqrt_pd(a); }
+static inline vd Gt(vd a, vd b) { return _mm_cmpgt_pd(a, b); }
+static inline vd Ge(vd a, vd b) { return _mm_cmpge_pd(a, b); }
+static inline vd Le(vd a, vd b) { return _mm_cmple_pd(a, b); }
+static inline vd And(vd a, vd b) { return _mm_and_pd(a, b); }
+static inline vd Or(vd a, vd b) { return _mm_or_pd(a, b); }
+static inline vd Xor(vd a, vd b) { return _mm_xor_pd(a, b); }
+static inline int Mask(vd m) { return _mm_movemask_pd(m); }
+#endif
+
+// RA for angles in (-540, 540]
+static inline vd RA(vd angle) {
+    angle = Sub(angle, And(Gt(angle, Set1(180.0)), Set1(360.0)));
+    return Add(angle, And(Le(angle, Set1(-180.0)), Set1(360.0)));
+}
+
+}  // namespace simd
+#endif
+
+// x[i], y[i] = pos[i] - a
+static inline void BatchDiff(const LLPos& a, const double *lat, const double *lon, size_t n,
+                             double *x, double *y) {
+    double c = cosf(a.lat * 0.01745329252);     // as in operator-
+    size_t i = 0;
+
+#ifdef FLAT_EARTH_SIMD
+    using namespace simd;
+    vd a_lat = Set1(a.lat), a_lon = Set1(a.lon), vc = Set1(c), vl2m = Set1(kLat2m);
+    for (; i + kWidth <= n; i += kWidth) {
+        Store(x + i, Mul(Mul(RA(Sub(Load(lon + i), a_lon)), vl2m), vc));
+        Store(y + i, Mul(RA(Sub(Load(lat + i), a_lat)), vl2m));
+    }
+#endif
+
+    for (; i < n; i++) {
+        x[i] = RA(lon[i] - a.lon) * kLat2m * c;
+        y[i] = RA(lat[i] - a.lat) * kLat2m;
+    }
+}
+
+// dist[i] = len(pos[i] - a)
+static inline void BatchDist(const LLPos& a, const double *lat, const double *lon, size_t n, double *dist) {
+    double c = cosf(a.lat * 0.01745329252);     // as in operator-
+    size_t i = 0;
+
+#ifdef FLAT_EARTH_SIMD
+    using namespace simd;
+    vd a_lat = Set1(a.lat), a_lon = Set1(a.lon), vc = Set1(c), vl2m = Set1(kLat2m);
+    for (; i + kWidth <= n; i += kWidth) {
+        vd x = Mul(Mul(RA(Sub(Load(lon + i), a_lon)), vl2m), vc);
+        vd y = Mul(RA(Sub(Load(lat + i), a_lat)), vl2m);
+        Store(dist + i, Sqrt(Add(Mul(x, x), Mul(y, y))));
+    }
+#endif
+
+    for (; i < n; i++) {
+        double x = RA(lon[i] - a.lon) * kLat2m * c;
+        double y = RA(lat[i] - a.lat) * kLat2m;
+        dist[i] = sqrt(x * x + y * y);
+    }
+}
+
+// dot[i] = (pos[i] - a) * v, e.g. the distance along a unit vector v
+static inline void BatchDot(const LLPos& a, const double *lat, const double *lon, size_t n,
+                            const Vec2& v, double *dot) {
+    double c = cosf(a.lat * 0.01745329252);     // as in operator-
+    size_t i = 0;
+
+#ifdef FLAT_EARTH_SIMD
+    using namespace simd;
+    vd a_lat = Set1(a.lat), a_lon = Set1(a.lon), vc = Set1(c), vl2m = Set1(kLat2m);
+    vd vx = Set1(v.x), vy = Set1(v.y);
+    for (; i + kWidth <= n; i += kWidth) {
+        vd x = Mul(Mul(RA(Sub(Load(lon + i), a_lon)), vl2m), vc);
+        vd y = Mul(RA(Sub(Load(lat + i), a_lat)), vl2m);
+        Store(dot + i, Add(Mul(x, vx), Mul(y, vy)));
+    }
+#endif
+
+    for (; i < n; i++) {
+        double x = RA(lon[i] - a.lon) * kLat2m * c;
+        double y = RA(lat[i] - a.lat) * kLat2m;
+        dot[i] = x * v.x + y * v.y;
+    }
+}
+
+// in[i] = InRect(pos[i], lower_left, upper_right)
+static inline void BatchInRect(const double *lat, const double *lon, size_t n,
+                               const LLPos& lower_left, const LLPos& upper_right, uint8_t *in) {
+    size_t i = 0;
+
+#ifdef FLAT_EARTH_SIMD
+    using namespace simd;
+    bool crosses = !(lower_left.lon < upper_right.lon);   // the antimeridian
+    vd ll_lat = Set1(lower_left.lat), ll_lon = Set1(lower_left.lon);
+    vd ur_lat = Set1(upper_right.lat), ur_lon = Set1(upper_right.lon);
+    for (; i + kWidth <= n; i += kWidth) {
+        vd p_lat = Load(lat + i);
+        vd p_lon = RA(Load(lon + i));
+        vd lat_ok = And(Ge(p_lat, ll_lat), Le(p_lat, ur_lat));
+        vd lon_ok = crosses ? Or(Gt(p_lon, ll_lon), Le(p_lon, ur_lon)) : And(Gt(p_lon, ll_lon), Le(p_lon, ur_lon));
+        int m = Mask(And(lat_ok, lon_ok));
+        for (size_t k = 0; k < kWidth; k++)
+            in[i + k] = (m >> k) & 1;
+    }
+#endif
+
+    for (; i < n; i++)
+        in[i] = InRect(LLPos(lat[i], lon[i]), lower_left, upper_right);
+}
+
+}  // namespace flat_earth_math
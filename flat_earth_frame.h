@@ -0,0 +1,96 @@
+//
+//    Copyright (C) 2026 Holger Teutsch
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 2.1 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+//    USA
+//
+
+// The vector space attached at a fixed origin, optionally rotated to a heading.
+//
+// LocalFrame stand(stand_pos, stand_hdg);     // once
+// Vec2 v = stand.ToLocal(acf_pos);            // each frame, v.x right of, v.y along the centreline
+// LLPos p = stand.ToLL({0.0, -30.0});         // 30 m behind the stand
+//
+// All scale factors and the rotation are computed once in the constructor so the
+// projections are a few multiplications and adds without any trig.
+// Contrary to operator- the cos of the latitude is computed in double precision, so
+// results may differ from it in the order of 1e-7 relative.
+//
+// If the cos of the latitude and the heading's sin and cos are known at compile time
+// a frame can be constexpr:
+//
+// static constexpr LocalFrame frame(LLPos(50.0, 8.0), 0.6427876097, 0.0, 1.0);
+//
+
+#pragma once
+#include <cstddef>
+
+#include "flat_earth_math.h"
+
+namespace flat_earth_math {
+
+class LocalFrame {
+    LLPos origin_;
+    double cx_, icx_;           // m per ° lon and reverse
+    double sin_, cos_;          // of the heading
+
+  public:
+    // heading in degrees true, the frame's y axis points to the heading
+    explicit LocalFrame(const LLPos& origin, double hdg = 0.0)
+        : LocalFrame(origin, cos(origin.lat * 0.017453292519943295), sin(hdg * 0.017453292519943295),
+                     cos(hdg * 0.017453292519943295)) {}
+
+    constexpr LocalFrame(const LLPos& origin, double cos_lat, double sin_hdg, double cos_hdg)
+        : origin_(origin),
+          cx_(kLat2m * cos_lat),
+          icx_(1.0 / (kLat2m * cos_lat)),
+          sin_(sin_hdg),
+          cos_(cos_hdg) {}
+
+    constexpr const LLPos& Origin() const { return origin_; }
+
+    // (east, north) -> frame
+    constexpr Vec2 Rotate(const Vec2& v) const {
+        return {v.x * cos_ - v.y * sin_, v.x * sin_ + v.y * cos_};
+    }
+
+    // frame -> (east, north)
+    constexpr Vec2 Unrotate(const Vec2& v) const {
+        return {v.x * cos_ + v.y * sin_, v.y * cos_ - v.x * sin_};
+    }
+
+    // forward projection, p - origin in frame coordinates
+    Vec2 ToLocal(const LLPos& p) const {
+        return Rotate({RA(p.lon - origin_.lon) * cx_, RA(p.lat - origin_.lat) * kLat2m});
+    }
+
+    // inverse projection, origin + v with v in frame coordinates
+    LLPos ToLL(const Vec2& v) const {
+        Vec2 en = Unrotate(v);
+        return LLPos(RA(origin_.lat + en.y * (1.0 / kLat2m)), RA(origin_.lon + en.x * icx_));
+    }
+
+    void ToLocal(const LLPos *p, size_t n, Vec2 *v) const {
+        for (size_t i = 0; i < n; i++)
+            v[i] = ToLocal(p[i]);
+    }
+
+    void ToLL(const Vec2 *v, size_t n, LLPos *p) const {
+        for (size_t i = 0; i < n; i++)
+            p[i] = ToLL(v[i]);
+    }
+};
+
+}  // namespace flat_earth_math
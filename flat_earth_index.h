@@ -0,0 +1,181 @@
+//
+//    Copyright (C) 2026 Holger Teutsch
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 2.1 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+//    USA
+//
+
+// Static spatial index over positions, e.g. all stands of the loaded scenery
+//
+// LLIndex index(stands.data(), stands.size());
+// std::vector<size_t> res;
+// index.Nearest(acf_pos, 3, res);                 // indices into stands
+// index.Radius(acf_pos, 200.0, res);
+// index.Rect(lower_left, upper_right, res);
+//
+// Positions are bucketed into a lat/lon grid of cell x cell degrees. Only non empty cells
+// exist: positions are stored sorted by cell in contiguous arrays, so a query does one binary
+// search per row of cells and then walks adjacent memory.
+// Distances are those of operator- with the query position as origin, the grid wraps
+// at the antimeridian and Rect() has the semantics of InRect().
+//
+
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "flat_earth_math.h"
+
+namespace flat_earth_math {
+
+class LLIndex {
+    double cell_;                   // cell size in degrees
+    int n_lat_, n_lon_;             // # of cells
+    std::vector<int64_t> keys_;     // cell of each position, sorted
+    std::vector<LLPos> pos_;        // positions in the order of keys_
+    std::vector<uint32_t> idx_;     // original index
+
+    int LatCell(double lat) const {
+        return std::clamp((int)floor((lat + 90.0) / cell_), 0, n_lat_ - 1);
+    }
+
+    int LonCell(double lon) const {
+        return std::clamp((int)floor((RA(lon) + 180.0) / cell_), 0, n_lon_ - 1);
+    }
+
+    int64_t Key(int ilat, int ilon) const { return (int64_t)ilat * n_lon_ + ilon; }
+
+    // call f(i) for all positions in cells [ilon0, ilon1] of row ilat
+    template <typename F>
+    void ScanRow(int ilat, int ilon0, int ilon1, F&& f) const {
+        int64_t k1 = Key(ilat, ilon1);
+        size_t i = std::lower_bound(keys_.begin(), keys_.end(), Key(ilat, ilon0)) - keys_.begin();
+        for (; i < keys_.size() && keys_[i] <= k1; i++)
+            f(i);
+    }
+
+    // call f(i) for all positions in the cells covering [lat0, lat1] x [lon0, lon1],
+    // lon0 <= lon1 but they may be outside of [-180, 180]
+    template <typename F>
+    void Scan(double lat0, double lat1, double lon0, double lon1, F&& f) const {
+        int ilat0 = LatCell(lat0), ilat1 = LatCell(lat1);
+        bool all = (lon1 - lon0 >= 360.0);
+        int ilon0 = all ? 0 : LonCell(lon0);
+        int ilon1 = all ? n_lon_ - 1 : LonCell(lon1);
+
+        for (int ilat = ilat0; ilat <= ilat1; ilat++) {
+            if (ilon0 <= ilon1) {
+                ScanRow(ilat, ilon0, ilon1, f);
+            } else {    // crosses the antimeridian
+                ScanRow(ilat, ilon0, n_lon_ - 1, f);
+                ScanRow(ilat, 0, ilon1, f);
+            }
+        }
+    }
+
+  public:
+    static constexpr double kMinCell = 1.0E-4, kMaxCell = 90.0;
+
+    // cell size in degrees, ~ the typical query radius is a good choice
+    // it's clamped to [kMinCell, kMaxCell], also a value <= 0 or NaN gives kMinCell
+    LLIndex(const LLPos *pos, size_t n, double cell = 0.01)
+        : cell_(cell >= kMinCell ? std::min(cell, kMaxCell) : kMinCell),
+          n_lat_((int)ceil(180.0 / cell_)),
+          n_lon_((int)ceil(360.0 / cell_)) {
+        std::vector<std::pair<int64_t, uint32_t>> order(n);
+        for (size_t i = 0; i < n; i++)
+            order[i] = {Key(LatCell(pos[i].lat), LonCell(pos[i].lon)), (uint32_t)i};
+        std::sort(order.begin(), order.end());
+
+        keys_.reserve(n);
+        pos_.reserve(n);
+        idx_.reserve(n);
+        for (auto& o : order) {
+            keys_.push_back(o.first);
+            pos_.push_back(pos[o.second]);
+            idx_.push_back(o.second);
+        }
+    }
+
+    size_t Size() const { return pos_.size(); }
+
+    // indices of all positions within radius m of p, unordered
+    void Radius(const LLPos& p, double radius, std::vector<size_t>& res) const {
+        res.clear();
+        double dlat = radius / kLat2m;
+        double c = cosf(p.lat * 0.01745329252);
+        double dlon = (c * 360.0 * kLat2m > radius) ? radius / (kLat2m * c) : 360.0;
+
+        Scan(p.lat - dlat, p.lat + dlat, p.lon - dlon, p.lon + dlon, [&](size_t i) {
+            if (len(pos_[i] - p) <= radius)
+                res.push_back(idx_[i]);
+        });
+    }
+
+    // indices of all positions that are InRect(lower_left, upper_right), unordered
+    void Rect(const LLPos& lower_left, const LLPos& upper_right, std::vector<size_t>& res) const {
+        res.clear();
+        double lon1 = upper_right.lon;
+        if (!(lower_left.lon < lon1))
+            lon1 += 360.0;
+
+        Scan(lower_left.lat, upper_right.lat, lower_left.lon, lon1, [&](size_t i) {
+            if (InRect(pos_[i], lower_left, upper_right))
+                res.push_back(idx_[i]);
+        });
+    }
+
+    // indices of the k nearest positions to p, ordered by distance
+    // if dist is given it receives the distances in m
+    void Nearest(const LLPos& p, size_t k, std::vector<size_t>& res, std::vector<double> *dist = nullptr) const {
+        res.clear();
+        if (dist)
+            dist->clear();
+
+        k = std::min(k, pos_.size());
+        if (k == 0)
+            return;
+
+        // grow the search radius until it contains k positions, all closer ones are in there as well
+        std::vector<std::pair<double, size_t>> cand;
+        for (double radius = cell_ * kLat2m;; radius *= 2.0) {
+            cand.clear();
+            double dlat = radius / kLat2m;
+            double c = cosf(p.lat * 0.01745329252);
+            double dlon = (c * 360.0 * kLat2m > radius) ? radius / (kLat2m * c) : 360.0;
+
+            Scan(p.lat - dlat, p.lat + dlat, p.lon - dlon, p.lon + dlon, [&](size_t i) {
+                double d = len(pos_[i] - p);
+                if (d <= radius)
+                    cand.push_back({d, i});
+            });
+
+            if (cand.size() >= k || radius > 4.0E7)
+                break;
+        }
+
+        k = std::min(k, cand.size());
+        std::partial_sort(cand.begin(), cand.begin() + k, cand.end());
+        for (size_t j = 0; j < k; j++) {
+            res.push_back(idx_[cand[j].second]);
+            if (dist)
+                dist->push_back(cand[j].first);
+        }
+    }
+};
+
+}  // namespace flat_earth_math
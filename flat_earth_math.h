@@ -62,7 +62,7 @@ static inline float RA(float angle) {
 struct LLPos {
     double lon, lat;  // right, up
     LLPos() = default;
-    LLPos(double lat, double lon) : lon(lon), lat(lat) {}  // in conventional order (lat, lon)
+    constexpr LLPos(double lat, double lon) : lon(lon), lat(lat) {}  // in conventional order (lat, lon)
 };
 
 struct Vec2 {
@@ -0,0 +1,179 @@
+//
+//    Copyright (C) 2026 Holger Teutsch
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 2.1 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+//    USA
+//
+
+// Polygons and polylines in the vector space, e.g. stand areas and lead-in lines
+//
+// Vertices are contiguous Vec2 arrays relative to some origin, typically obtained
+// with LocalFrame::ToLocal() from LLPos.
+//
+// Polygon area(v, n);                             // once
+// bool in = area.Contains(acf);
+// area.Contains(x, y, n_pts, in);                 // many points, structure of arrays
+//
+// TrackPos tp = NearestOnPolyline(acf, lead_in, n);   // distance, along and cross track
+//
+// Containment is by the crossing number (even-odd) rule, points exactly on an
+// edge may be in or out.
+//
+
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "flat_earth_batch.h"
+
+namespace flat_earth_math {
+
+// distance of p to segment [a, b]
+static inline double DistToSegment(const Vec2& p, const Vec2& a, const Vec2& b) {
+    Vec2 d = b - a, w = p - a;
+    double dd = d * d;
+    double t = (dd > 0.0) ? std::clamp((w * d) / dd, 0.0, 1.0) : 0.0;
+    return len(w - t * d);
+}
+
+// single polygon test without any preparation, v[n - 1] connects to v[0]
+static inline bool InPolygon(const Vec2& p, const Vec2 *v, size_t n) {
+    bool in = false;
+    for (size_t i = 0, j = n - 1; i < n; j = i++) {
+        if ((v[i].y > p.y) != (v[j].y > p.y) &&
+            p.x < v[j].x + (p.y - v[j].y) * (v[i].x - v[j].x) / (v[i].y - v[j].y))
+            in = !in;
+    }
+
+    return in;
+}
+
+// Polygon prepared for many tests: bounding box and the edges as structure of arrays
+class Polygon {
+    Vec2 min_, max_;
+    std::vector<double> x0_, y0_, y1_, slope_;   // edge (x0, y0) -> (., y1), dx / dy
+
+  public:
+    Polygon(const Vec2 *v, size_t n) : min_{0.0, 0.0}, max_{-1.0, -1.0} {
+        if (n < 3)
+            return;     // empty box, contains nothing
+
+        min_ = max_ = v[0];
+        x0_.reserve(n);
+        y0_.reserve(n);
+        y1_.reserve(n);
+        slope_.reserve(n);
+
+        for (size_t i = 0, j = n - 1; i < n; j = i++) {
+            min_ = {std::min(min_.x, v[i].x), std::min(min_.y, v[i].y)};
+            max_ = {std::max(max_.x, v[i].x), std::max(max_.y, v[i].y)};
+            if (v[i].y == v[j].y)
+                continue;   // horizontal edges are never crossed
+
+            x0_.push_back(v[j].x);
+            y0_.push_back(v[j].y);
+            y1_.push_back(v[i].y);
+            slope_.push_back((v[i].x - v[j].x) / (v[i].y - v[j].y));
+        }
+    }
+
+    bool Contains(const Vec2& p) const {
+        if (!(p.x >= min_.x && p.x <= max_.x && p.y >= min_.y && p.y <= max_.y))
+            return false;
+
+        bool in = false;
+        for (size_t e = 0; e < x0_.size(); e++) {
+            if ((y0_[e] > p.y) != (y1_[e] > p.y) && p.x < x0_[e] + (p.y - y0_[e]) * slope_[e])
+                in = !in;
+        }
+
+        return in;
+    }
+
+    // in[i] = Contains({x[i], y[i]})
+    void Contains(const double *x, const double *y, size_t n, uint8_t *in) const {
+        size_t i = 0;
+
+#ifdef FLAT_EARTH_SIMD
+        using namespace simd;
+        vd min_x = Set1(min_.x), min_y = Set1(min_.y), max_x = Set1(max_.x), max_y = Set1(max_.y);
+        for (; i + kWidth <= n; i += kWidth) {
+            vd px = Load(x + i), py = Load(y + i);
+            vd box = And(And(Ge(px, min_x), Le(px, max_x)), And(Ge(py, min_y), Le(py, max_y)));
+            vd odd = Set1(0.0);
+
+            if (Mask(box)) {        // the common case at an airport is outside
+                for (size_t e = 0; e < x0_.size(); e++) {
+                    vd y0 = Set1(y0_[e]);
+                    vd straddle = Xor(Gt(y0, py), Gt(Set1(y1_[e]), py));
+                    vd left = Gt(Add(Set1(x0_[e]), Mul(Sub(py, y0), Set1(slope_[e]))), px);
+                    odd = Xor(odd, And(straddle, left));
+                }
+            }
+
+            int m = Mask(And(box, odd));
+            for (size_t k = 0; k < kWidth; k++)
+                in[i + k] = (m >> k) & 1;
+        }
+#endif
+
+        for (; i < n; i++)
+            in[i] = Contains(Vec2{x[i], y[i]});
+    }
+};
+
+// position relative to a polyline
+struct TrackPos {
+    double dist;        // to the nearest point of the polyline
+    double along;       // polyline length up to the nearest point
+    double cross;       // cross track, > 0 right of the direction v[0] -> v[n - 1]
+    size_t seg;         // nearest segment v[seg] -> v[seg + 1]
+};
+
+// nearest point on polyline v[0] ... v[n - 1]
+static inline TrackPos NearestOnPolyline(const Vec2& p, const Vec2 *v, size_t n) {
+    TrackPos tp{std::numeric_limits<double>::infinity(), 0.0, 0.0, 0};
+    if (n == 0)
+        return tp;
+
+    if (n == 1) {
+        tp.dist = len(p - v[0]);
+        return tp;
+    }
+
+    double start = 0.0;     // polyline length up to v[i]
+    for (size_t i = 0; i + 1 < n; i++) {
+        Vec2 d = v[i + 1] - v[i], w = p - v[i];
+        double l = len(d);
+        double t = (l > 0.0) ? std::clamp((w * d) / (l * l), 0.0, 1.0) : 0.0;
+        double dist = len(w - t * d);
+
+        if (dist < tp.dist) {
+            tp.dist = dist;
+            tp.along = start + t * l;
+            tp.cross = (l > 0.0) ? (w.x * d.y - w.y * d.x) / l : 0.0;
+            tp.seg = i;
+        }
+
+        start += l;
+    }
+
+    return tp;
+}
+
+}  // namespace flat_earth_math
@@ -0,0 +1,138 @@
+//
+//    Copyright (C) 2026 Holger Teutsch
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 2.1 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+//    USA
+//
+
+// Approximate trig in degrees without libm calls or data dependent loops
+//
+// float c = Cos<kTrigLow>(lat);                   // for display
+// double hdg = Bearing<kTrigHigh>(stand_pos - acf_pos);
+//
+// Angles are reduced with one multiply and ceil, then sin and atan are polynomials
+// (Chebyshev interpolants) on [-90°, 90°] and [0, tan(22.5°)]. The tier sets the degree.
+// Max absolute error against long double libm, measured with 2e7 random double arguments
+// in [-720°, 720°] resp. all quadrants and for Sin with all float arguments in [-720°, 720°]:
+//
+//                  Sin, Cos    Sin(float)    Atan2, Bearing
+//   kTrigLow       1.4e-4      1.4e-4        3.9e-4°   (6.8e-6 rad)
+//   kTrigMedium    1.2e-6      1.4e-6        1.2e-5°   (2.1e-7 rad)
+//   kTrigHigh      1.2e-15     1.7e-7        5.2e-14°  (9.0e-16 rad)
+//
+// So kTrigHigh only makes sense for double.
+//
+// The selections (?:) in the reduction compile to blends or cmov.
+//
+
+#pragma once
+#include <cmath>
+#include <cstddef>
+
+#include "flat_earth_math.h"
+
+namespace flat_earth_math {
+
+enum TrigAccuracy { kTrigLow, kTrigMedium, kTrigHigh };
+
+namespace trig {
+
+template <TrigAccuracy A> struct Coef;
+
+// sin(t) = t * P(t²) on [-pi/2, pi/2], atan(z) = z * P(z²) on [0, tan(pi/8)]
+template <> struct Coef<kTrigLow> {
+    static constexpr double sin[] = {0.9999115283796041, -0.16602000425894728, 0.00762666215117787};
+    static constexpr double atan[] = {0.9999813450979945, -0.3313618483144501, 0.16806253719207753};
+};
+
+template <> struct Coef<kTrigMedium> {
+    static constexpr double sin[] = {0.9999992370615314, -0.16665676500413962, 0.008313191414377983,
+                                     -0.00018522539324657096};
+    static constexpr double atan[] = {0.9999994231681628, -0.3332252809249894, 0.19677712909107445,
+                                      -0.1110037220764055};
+};
+
+template <> struct Coef<kTrigHigh> {
+    static constexpr double sin[] = {0.9999999999999991,      -0.16666666666665045,   0.00833333333325888,
+                                     -0.0001984126982497507,  2.755731706124959e-06,  -2.5051926442031437e-08,
+                                     1.6049841345208152e-10,  -7.396739130027481e-13};
+    static constexpr double atan[] = {0.9999999999999991,   -0.33333333333317655, 0.20000000001076199,
+                                      -0.14285714655446277, 0.111111374401368,    -0.09091799063950165,
+                                      0.07709404389346146,  -0.06867007089345291, 0.07341770445111355,
+                                      -0.1170340163080235,  0.2038582642659699,   -0.19440506095997986};
+};
+
+template <typename T, size_t N>
+static inline T Horner(const double (&c)[N], T u) {
+    T r = T(c[N - 1]);
+    for (size_t i = N - 1; i > 0; i--)
+        r = r * u + T(c[i - 1]);
+    return r;
+}
+
+// atan(z) in rad for z in [0, 1]
+template <TrigAccuracy A, typename T>
+static inline T Atan01(T z) {
+    constexpr T kTanPi8 = T(0.41421356237309503);
+    bool big = z > kTanPi8;
+    z = big ? (z - T(1)) / (z + T(1)) : z;      // atan(z) = pi/4 + atan((z - 1) / (z + 1))
+    T r = z * Horner(Coef<A>::atan, z * z);
+    return big ? r + T(0.78539816339744828) : r;
+}
+
+}  // namespace trig
+
+// branch free RA(), (-180, 180]
+// The quotient can round up to an integer just above -180 + k * 360, hence the final select.
+template <typename T>
+static inline T RAFast(T angle) {
+    T r = angle - T(360) * std::ceil((angle - T(180)) * T(1.0 / 360.0));
+    return r > T(180) ? r - T(360) : r;
+}
+
+template <TrigAccuracy A = kTrigMedium, typename T>
+static inline T Sin(T deg) {
+    T x = RAFast(deg);
+    x = std::fabs(x) > T(90) ? std::copysign(T(180), x) - x : x;  // sin(180 - x) = sin(x)
+    T t = x * T(0.017453292519943295);
+    return t * trig::Horner(trig::Coef<A>::sin, t * t);
+}
+
+template <TrigAccuracy A = kTrigMedium, typename T>
+static inline T Cos(T deg) {
+    return Sin<A>(deg + T(90));
+}
+
+// atan2 in degrees, (-180, 180], 0 for y = x = 0
+template <TrigAccuracy A = kTrigMedium, typename T>
+static inline T Atan2(T y, T x) {
+    T ax = std::fabs(x), ay = std::fabs(y);
+    T mx = ax > ay ? ax : ay, mn = ax > ay ? ay : ax;
+    T r = trig::Atan01<A>(mx > T(0) ? mn / mx : T(0));
+    r = ay > ax ? T(1.5707963267948966) - r : r;
+    r = x < T(0) ? T(3.1415926535897931) - r : r;
+    r = y < T(0) ? -r : r;
+    return r * T(57.295779513082323);
+}
+
+// true bearing of v in degrees, [0, 360)
+template <TrigAccuracy A = kTrigMedium>
+static inline double Bearing(const Vec2& v) {
+    double b = Atan2<A>(v.x, v.y);
+    b = b < 0.0 ? b + 360.0 : b;
+    return b < 360.0 ? b : 0.0;     // b + 360 may round up
+}
+
+}  // namespace flat_earth_math
@@ -0,0 +1,438 @@
+//
+//    Copyright (C) 2026 Holger Teutsch
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 2.1 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+//    USA
+//
+
+// Benchmark of HttpGet() against a loopback HTTP server, POSIX only, see README for the build.
+//
+// ./http_bench [scale]             run all scenarios, scale multiplies the # of requests
+// ./http_bench -serve port         only run the server, e.g. for curl or a plugin under test
+//
+// Every url takes these query parameters:
+//   size=n     body size in bytes
+//   ms=n       latency before the response
+//   close=1    close the connection after the response
+//
+// /plain                   Content-Length body
+// /chunked?chunk=n         chunked transfer encoding
+// /redirect?n=k            k 302 redirects before the body
+// /gzip                    gzip content encoding if accepted
+// /etag                    304 if If-None-Match is the ETag "v1"
+// /drip?n=k&gap=ms         body in k pieces gap ms apart
+// /echo?v=str              body is the percent-decoded str
+//
+// First checks that names encoded by HttpUrlEncode() arrive unchanged.
+// For each scenario requests/s, p50/p99 latency, heap allocations per request of the
+// calling thread (operator new and libcurl) and the # of new connections are reported.
+// The log of HttpGet() goes to /dev/null.
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <curl/curl.h>
+#include <zlib.h>
+
+#include "http_get.h"
+
+const char *log_msg_prefix = "http_bench: ";
+
+// only allocations of the benchmark thread are counted, not those of the server
+static thread_local size_t n_alloc;
+
+void *operator new(size_t size) {
+    n_alloc++;
+    if (void *p = malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+// and those of libcurl
+static void *CurlMalloc(size_t size) { n_alloc++; return malloc(size); }
+static void *CurlRealloc(void *p, size_t size) { n_alloc++; return realloc(p, size); }
+static void *CurlCalloc(size_t n, size_t size) { n_alloc++; return calloc(n, size); }
+static char *CurlStrdup(const char *str) { n_alloc++; return strdup(str); }
+
+//
+// the server
+//
+static long Param(const std::string& query, const char *name, long def) {
+    std::string key = std::string(name) + "=";
+    for (size_t pos = 0; (pos = query.find(key, pos)) != std::string::npos; pos++) {
+        if (pos == 0 || query[pos - 1] == '&' || query[pos - 1] == '?')
+            return atol(query.c_str() + pos + key.size());
+    }
+
+    return def;
+}
+
+static std::string PercentDecode(const std::string& str) {
+    std::string res;
+    for (size_t i = 0; i < str.size(); i++) {
+        if (str[i] == '%' && i + 2 < str.size() &&
+            isxdigit((unsigned char)str[i + 1]) && isxdigit((unsigned char)str[i + 2])) {
+            res.push_back((char)strtol(str.substr(i + 1, 2).c_str(), nullptr, 16));
+            i += 2;
+        } else {
+            res.push_back(str[i]);
+        }
+    }
+
+    return res;
+}
+
+static std::string Header(const std::string& req, const char *name) {
+    std::string key = std::string("\r\n") + name + ":";
+    auto it = std::search(req.begin(), req.end(), key.begin(), key.end(),
+                          [](char a, char b) { return tolower(a) == tolower(b); });
+    if (it == req.end())
+        return "";
+
+    size_t pos = it - req.begin() + key.size();
+    size_t end = req.find("\r\n", pos);
+    pos = req.find_first_not_of(' ', pos);
+    return req.substr(pos, end - pos);
+}
+
+// compressible text that looks a bit like an OFP
+static std::string Body(size_t size) {
+    static const char line[] = "<fix><ident>DIMAB</ident><pos_lat>48.35</pos_lat><pos_long>11.78</pos_long></fix>\n";
+    std::string body;
+    body.reserve(size);
+    while (body.size() < size)
+        body.append(line, std::min(sizeof(line) - 1, size - body.size()));
+    return body;
+}
+
+static std::string Gzip(const std::string& data) {
+    z_stream zs{};
+    deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);  // + 16: gzip
+    std::string out(deflateBound(&zs, data.size()), '\0');
+    zs.next_in = (Bytef *)data.data();
+    zs.avail_in = data.size();
+    zs.next_out = (Bytef *)out.data();
+    zs.avail_out = out.size();
+    deflate(&zs, Z_FINISH);
+    out.resize(zs.total_out);
+    deflateEnd(&zs);
+    return out;
+}
+
+static bool SendAll(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n <= 0)
+            return false;
+        data += n;
+        len -= n;
+    }
+
+    return true;
+}
+
+static bool SendAll(int fd, const std::string& str) { return SendAll(fd, str.data(), str.size()); }
+
+static void Sleep(long ms) {
+    if (ms > 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// bodies are generated once per size
+static const std::string& CachedBody(size_t size, bool gzip) {
+    static std::mutex mtx;
+    static std::map<std::pair<size_t, bool>, std::string> bodies;
+    std::lock_guard<std::mutex> lock(mtx);
+    auto& b = bodies[{size, gzip}];
+    if (b.empty() && size > 0)
+        b = gzip ? Gzip(Body(size)) : Body(size);
+    return b;
+}
+
+// handle one request, returns false if the connection is to be closed
+static bool Serve(int fd, const std::string& req) {
+    size_t sp1 = req.find(' '), sp2 = req.find(' ', sp1 + 1);
+    if (sp1 == std::string::npos || sp2 == std::string::npos)
+        return false;
+
+    std::string target = req.substr(sp1 + 1, sp2 - sp1 - 1);
+    size_t q = target.find('?');
+    std::string path = target.substr(0, q);
+    std::string query = (q == std::string::npos) ? "" : target.substr(q + 1);
+
+    size_t size = Param(query, "size", 1024);
+    bool close = Param(query, "close", 0);
+    Sleep(Param(query, "ms", 0));
+
+    std::string hdr = "HTTP/1.1 200 OK\r\n";
+    std::string conn = close ? "Connection: close\r\n" : "";
+
+    if (path == "/plain" || path == "/drip") {
+        const std::string& body = CachedBody(size, false);
+        hdr += "Content-Length: " + std::to_string(body.size()) + "\r\n" + conn + "\r\n";
+        if (!SendAll(fd, hdr))
+            return false;
+
+        size_t pieces = std::max(1L, path == "/drip" ? Param(query, "n", 10) : 1);
+        long gap = Param(query, "gap", 10);
+        for (size_t i = 0; i < pieces; i++) {
+            size_t b = body.size() * i / pieces, e = body.size() * (i + 1) / pieces;
+            if (i > 0)
+                Sleep(gap);
+            if (!SendAll(fd, body.data() + b, e - b))
+                return false;
+        }
+    } else if (path == "/chunked") {
+        const std::string& body = CachedBody(size, false);
+        size_t chunk = std::max(1L, Param(query, "chunk", 4096));
+        hdr += "Transfer-Encoding: chunked\r\n" + conn + "\r\n";
+        if (!SendAll(fd, hdr))
+            return false;
+
+        for (size_t pos = 0; pos < body.size(); pos += chunk) {
+            size_t n = std::min(chunk, body.size() - pos);
+            char len[20];
+            snprintf(len, sizeof(len), "%zx\r\n", n);
+            if (!SendAll(fd, len, strlen(len)) || !SendAll(fd, body.data() + pos, n) || !SendAll(fd, "\r\n", 2))
+                return false;
+        }
+
+        if (!SendAll(fd, "0\r\n\r\n"))
+            return false;
+    } else if (path == "/redirect") {
+        long n = Param(query, "n", 1);
+        std::string loc = (n > 1) ? "/redirect?n=" + std::to_string(n - 1) + "&size=" + std::to_string(size)
+                                  : "/plain?size=" + std::to_string(size);
+        hdr = "HTTP/1.1 302 Found\r\nLocation: " + loc + "\r\nContent-Length: 0\r\n" + conn + "\r\n";
+        if (!SendAll(fd, hdr))
+            return false;
+    } else if (path == "/gzip") {
+        bool gzip = Header(req, "Accept-Encoding").find("gzip") != std::string::npos;
+        const std::string& body = CachedBody(size, gzip);
+        hdr += "Content-Length: " + std::to_string(body.size()) + "\r\n" + conn;
+        if (gzip)
+            hdr += "Content-Encoding: gzip\r\n";
+        if (!SendAll(fd, hdr + "\r\n") || !SendAll(fd, body))
+            return false;
+    } else if (path == "/echo") {
+        // v is the only parameter, a raw '&' or '#' would cut it short
+        std::string body = PercentDecode(query.compare(0, 2, "v=") == 0 ? query.substr(2) : "");
+        hdr += "Content-Length: " + std::to_string(body.size()) + "\r\n" + conn + "\r\n";
+        if (!SendAll(fd, hdr) || !SendAll(fd, body))
+            return false;
+    } else if (path == "/etag") {
+        if (Header(req, "If-None-Match") == "\"v1\"") {
+            hdr = "HTTP/1.1 304 Not Modified\r\nETag: \"v1\"\r\n" + conn + "\r\n";
+            if (!SendAll(fd, hdr))
+                return false;
+        } else {
+            const std::string& body = CachedBody(size, false);
+            hdr += "ETag: \"v1\"\r\nContent-Length: " + std::to_string(body.size()) + "\r\n" + conn + "\r\n";
+            if (!SendAll(fd, hdr) || !SendAll(fd, body))
+                return false;
+        }
+    } else {
+        hdr = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n" + conn + "\r\n";
+        if (!SendAll(fd, hdr))
+            return false;
+    }
+
+    return !close;
+}
+
+static void Connection(int fd) {
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    std::string buf;
+    char tmp[4096];
+    for (;;) {
+        size_t end;
+        while ((end = buf.find("\r\n\r\n")) == std::string::npos) {
+            ssize_t n = recv(fd, tmp, sizeof(tmp), 0);
+            if (n <= 0) {
+                close(fd);
+                return;
+            }
+            buf.append(tmp, n);
+        }
+
+        std::string req = buf.substr(0, end + 4);   // GET has no body
+        buf.erase(0, end + 4);
+        if (!Serve(fd, req))
+            break;
+    }
+
+    close(fd);
+}
+
+// listen on 127.0.0.1:port, 0 = any free port, returns the port or -1
+static int StartServer(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    socklen_t len = sizeof(addr);
+    if (bind(fd, (sockaddr *)&addr, len) < 0 || listen(fd, 128) < 0 || getsockname(fd, (sockaddr *)&addr, &len) < 0) {
+        perror("http_bench");
+        return -1;
+    }
+
+    std::thread([fd] {
+        for (;;) {
+            int c = accept(fd, nullptr, nullptr);
+            if (c >= 0)
+                std::thread(Connection, c).detach();
+        }
+    }).detach();
+
+    return ntohs(addr.sin_port);
+}
+
+//
+// the benchmark
+//
+struct Scenario {
+    const char *name;
+    const char *target;
+    int n;
+    bool conditional;       // send If-None-Match, expect 304
+    size_t size;            // expected body size
+};
+
+int main(int argc, char **argv) {
+    if (argc > 2 && strcmp(argv[1], "-serve") == 0) {
+        int port = StartServer(atoi(argv[2]));
+        if (port < 0)
+            return 1;
+        printf("serving on http://127.0.0.1:%d/\n", port);
+        for (;;)
+            pause();
+    }
+
+    double scale = (argc > 1) ? atof(argv[1]) : 1.0;
+
+    // before HttpDefaultClient() initializes libcurl
+    curl_global_init_mem(CURL_GLOBAL_ALL, CurlMalloc, free, CurlRealloc, CurlStrdup, CurlCalloc);
+
+    // the report goes to stdout, the log of each request to /dev/null
+    FILE *out = fdopen(dup(fileno(stdout)), "w");
+    if (!freopen("/dev/null", "w", stdout))
+        return 1;
+
+    int port = StartServer(0);
+    if (port < 0)
+        return 1;
+
+    static const Scenario scenarios[] = {
+        {"plain 1 kB", "/plain?size=1000", 2000, false, 1000},
+        {"plain 100 kB", "/plain?size=100000", 500, false, 100000},
+        {"plain 1 kB, new connection", "/plain?size=1000&close=1", 500, false, 1000},
+        {"latency 5 ms", "/plain?size=1000&ms=5", 100, false, 1000},
+        {"chunked 100 kB", "/chunked?size=100000&chunk=4096", 500, false, 100000},
+        {"2 redirects", "/redirect?n=2&size=1000", 500, false, 1000},
+        {"gzip 100 kB", "/gzip?size=100000", 500, false, 100000},
+        {"304", "/etag?size=100000", 2000, true, 0},
+        {"drip 10 x 2 ms", "/drip?size=10000&n=10&gap=2", 50, false, 10000},
+    };
+
+    std::string base = "http://127.0.0.1:" + std::to_string(port);
+    HttpClient& client = HttpDefaultClient();
+    std::string data;
+    HttpResponse resp;
+    int failed = 0;
+
+    // user names as entered for SimBrief
+    static const char *names[] = {"jdoe", "John Doe", "a&b=c", "x#1", "1+1", "50%", "a/b?c", "Müller", "~j.d-o_e"};
+    for (const char *name : names) {
+        if (!HttpGet(base + "/echo?v=" + HttpUrlEncode(name), data, 10) || data != name) {
+            fprintf(out, "HttpUrlEncode: '%s' arrived as '%s'\n", name, data.c_str());
+            failed++;
+        }
+    }
+
+    static const char *encoded = "J%C3%B6rg%20D.%26%23%2B~_-";
+    if (HttpUrlEncode("Jörg D.&#+~_-") != encoded) {
+        fprintf(out, "HttpUrlEncode: '%s', expected '%s'\n", HttpUrlEncode("Jörg D.&#+~_-").c_str(), encoded);
+        failed++;
+    }
+
+    fprintf(out, "%-28s %8s %9s %9s %8s %6s\n", "", "req/s", "p50 ms", "p99 ms", "allocs", "conns");
+    for (auto& sc : scenarios) {
+        int n = std::max(1, int(sc.n * scale));
+        std::string url = base + sc.target;
+        std::vector<std::string> headers;
+        if (sc.conditional)
+            headers.push_back("If-None-Match: \"v1\"");
+
+        // warm up the connection
+        HttpGet(url, data, 10);
+
+        std::vector<double> lat;
+        lat.reserve(n);
+        int errors = 0;
+        HttpTimingStats ts0 = client.TimingStats();
+        size_t a0 = n_alloc;
+        auto t0 = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < n; i++) {
+            auto t = std::chrono::steady_clock::now();
+            bool ok = sc.conditional ? client.Get(url, data, 10, headers, resp) && resp.status == 304
+                                     : HttpGet(url, data, 10) && data.size() == sc.size;
+            lat.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t).count());
+            errors += !ok;
+        }
+
+        double dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        double allocs = double(n_alloc - a0) / n;
+        HttpTimingStats ts1 = client.TimingStats();
+
+        std::sort(lat.begin(), lat.end());
+        fprintf(out, "%-28s %8.0f %9.3f %9.3f %8.1f %6u", sc.name, n / dt, lat[n / 2], lat[std::min(n - 1, n * 99 / 100)],
+               allocs, ts1.new_connections - ts0.new_connections);
+        if (errors) {
+            fprintf(out, "  %d ERRORS", errors);
+            failed++;
+        }
+        fprintf(out, "\n");
+    }
+
+    client.Stop();
+    fprintf(out, "%s\n", failed ? "FAILED" : "OK");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,204 @@
+//
+//    Copyright (C) 2026 Holger Teutsch
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 2.1 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+//    USA
+//
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <functional>
+#include <thread>
+
+#include "http_cache.h"
+#include "log_msg.h"
+
+// A cache file consists of 4 header lines followed by the body:
+// url, etag, last-modified, expiry time (time_t, 0 = must revalidate)
+struct CacheEntry {
+    std::string url, etag, last_modified;
+    time_t expires;
+    std::string body;
+};
+
+static bool ReadEntry(const std::string& path, CacheEntry& e) {
+    FILE *f = fopen(path.c_str(), "rb");
+    if (f == nullptr)
+        return false;
+
+    std::string str;
+    char buffer[16 * 1024];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0)
+        str.append(buffer, n);
+    fclose(f);
+
+    std::string *lines[3] = {&e.url, &e.etag, &e.last_modified};
+    size_t pos = 0;
+    for (int i = 0; i < 4; i++) {
+        size_t nl = str.find('\n', pos);
+        if (nl == std::string::npos)
+            return false;
+
+        if (i < 3)
+            lines[i]->assign(str, pos, nl - pos);
+        else
+            e.expires = atoll(str.c_str() + pos);
+        pos = nl + 1;
+    }
+
+    e.body.assign(str, pos);
+    return true;
+}
+
+static bool WriteEntry(const std::string& path, const std::string& url, const std::string& etag,
+                       const std::string& last_modified, time_t expires, const std::string& body) {
+    // write to a temp file and rename so readers never see a partial entry
+    std::string tmp = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+    FILE *f = fopen(tmp.c_str(), "wb");
+    if (f == nullptr) {
+        LogMsg("Can't create cache file '%s'", tmp.c_str());
+        return false;
+    }
+
+    fprintf(f, "%s\n%s\n%s\n%lld\n", url.c_str(), etag.c_str(), last_modified.c_str(), (long long)expires);
+    bool ok = fwrite(body.data(), 1, body.size(), f) == body.size();
+    ok = (fclose(f) == 0) && ok;
+
+    std::error_code ec;
+    if (ok)
+        std::filesystem::rename(tmp, path, ec);
+
+    if (!ok || ec) {
+        LogMsg("Can't write cache file '%s'", path.c_str());
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+
+    return true;
+}
+
+// Return expiry time according to Cache-Control,
+// 0 if the entry must be revalidated, -1 if the response must not be stored
+static time_t Expires(const std::string& cache_control, time_t now) {
+    std::string cc(cache_control);
+    for (auto& c : cc)
+        c = tolower((unsigned char)c);
+
+    if (cc.find("no-store") != std::string::npos)
+        return -1;
+
+    if (cc.find("no-cache") != std::string::npos)
+        return 0;
+
+    size_t pos = cc.find("max-age=");
+    if (pos == std::string::npos)
+        return 0;
+
+    long max_age = atol(cc.c_str() + pos + 8);
+    return max_age > 0 ? now + max_age : 0;
+}
+
+HttpCache::HttpCache(HttpClient& client, const std::string& dir)
+    : client_(client), dir_(dir), hits_(0), revalidated_(0), misses_(0), stale_(0) {
+    std::error_code ec;
+    std::filesystem::create_directories(dir_, ec);
+    if (ec)
+        LogMsg("Can't create cache directory '%s': %s", dir_.c_str(), ec.message().c_str());
+}
+
+std::string HttpCache::Path(const std::string& url) const {
+    // FNV-1a, a collision is detected by the url stored in the file
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (unsigned char c : url)
+        h = (h ^ c) * 0x100000001b3ULL;
+
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.cache", (unsigned long long)h);
+    return dir_ + "/" + name;
+}
+
+bool HttpCache::Get(const std::string& url, std::string& data, int timeout) {
+    std::string path = Path(url);
+    CacheEntry e;
+    bool have = ReadEntry(path, e) && e.url == url;
+
+    time_t now = time(nullptr);
+    if (have && now < e.expires) {
+        hits_++;
+        data = std::move(e.body);
+        return true;
+    }
+
+    std::vector<std::string> headers;
+    if (have) {
+        if (!e.etag.empty())
+            headers.push_back("If-None-Match: " + e.etag);
+        if (!e.last_modified.empty())
+            headers.push_back("If-Modified-Since: " + e.last_modified);
+    }
+
+    HttpResponse resp;
+    bool ok = client_.Get(url, data, timeout, headers, resp);
+    if (!ok || resp.status >= 500) {
+        if (!have) {
+            data.clear();
+            return false;
+        }
+
+        stale_++;
+        if (ok)
+            LogMsg("HTTP status %ld, serving stale cache entry for '%s'", resp.status, url.c_str());
+        else
+            LogMsg("request failed, serving stale cache entry for '%s'", url.c_str());
+        data = std::move(e.body);
+        return true;
+    }
+
+    if (have && resp.status == 304) {
+        revalidated_++;
+        time_t expires = Expires(resp.cache_control, now);
+        if (expires > 0)
+            WriteEntry(path, url, e.etag, e.last_modified, expires, e.body);
+        data = std::move(e.body);
+        return true;
+    }
+
+    if (resp.status != 200) {
+        LogMsg("HTTP status %ld for '%s'", resp.status, url.c_str());
+        data.clear();
+        return false;
+    }
+
+    misses_++;
+    time_t expires = Expires(resp.cache_control, now);
+    if (expires > 0 || (expires == 0 && !(resp.etag.empty() && resp.last_modified.empty())))
+        WriteEntry(path, url, resp.etag, resp.last_modified, expires, data);
+
+    return true;
+}
+
+HttpCacheStats HttpCache::Stats() const {
+    return {hits_.load(), revalidated_.load(), misses_.load(), stale_.load()};
+}
+
+void HttpCache::LogStats() const {
+    HttpCacheStats s = Stats();
+    LogMsg("HttpCache '%s': hits: %u, revalidated: %u, misses: %u, stale: %u",
+           dir_.c_str(), s.hits, s.revalidated, s.misses, s.stale);
+}
@@ -0,0 +1,61 @@
+//
+//    Copyright (C) 2026 Holger Teutsch
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 2.1 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+//    USA
+//
+
+#ifndef _HTTP_CACHE_H_
+#define _HTTP_CACHE_H_
+
+// Persistent HTTP cache on top of HttpClient
+//
+// Bodies and validators (ETag, Last-Modified) are stored in a plugin local directory.
+// While an entry is fresh according to Cache-Control max-age no request is sent at all,
+// otherwise it is revalidated with If-None-Match / If-Modified-Since and a 304 is served
+// from the cache. If the server can't be reached or answers with 5xx a stale entry is served.
+
+#include <atomic>
+#include <string>
+
+#include "http_get.h"
+
+struct HttpCacheStats {
+    unsigned hits;              // served without a request
+    unsigned revalidated;       // served after a 304
+    unsigned misses;            // body downloaded
+    unsigned stale;             // served after a failed request
+};
+
+class HttpCache {
+    HttpClient& client_;
+    std::string dir_;
+    std::atomic<unsigned> hits_, revalidated_, misses_, stale_;
+
+    std::string Path(const std::string& url) const;
+
+  public:
+    // dir is created if it does not exist
+    HttpCache(HttpClient& client, const std::string& dir);
+
+    // Returns true if data is a body with status 200, either fresh or from the cache.
+    // Other responses and failures without a cache entry return false.
+    bool Get(const std::string& url, std::string& data, int timeout);
+
+    HttpCacheStats Stats() const;
+    void LogStats() const;
+};
+
+#endif
@@ -17,30 +17,271 @@
 //    USA
 //
 
+#include <cmath>
 #include <cstdlib>
 #include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <thread>
 
 #include "http_get.h"
 #include "log_msg.h"
+#include "trace.h"
+
+// upper limit for presizing buffers from Content-Length
+static constexpr long kMaxPresize = 64 * 1024 * 1024;
+
+static constexpr int kLatencySamples = 128;
+
+// latency samples for hedging, retry statistics and running hedge legs
+struct HttpRetryState {
+    std::mutex mutex;
+    double samples[kLatencySamples];
+    int n_samples;
+    HttpRetryStats stats;
+
+    std::condition_variable cv;
+    int n_legs;
+
+    void AddSample(double t) {
+        samples[n_samples++ % kLatencySamples] = t;
+    }
+
+    double P95(int min_samples) {
+        int n = std::min(n_samples, kLatencySamples);
+        if (n == 0 || n < min_samples)
+            return 0.0;
+
+        double s[kLatencySamples];
+        std::copy(samples, samples + n, s);
+        int k = (n * 95) / 100;
+        std::nth_element(s, s + k, s + n);
+        return s[k];
+    }
+
+    // legs run detached, so wait for them before the client goes away
+    void WaitLegs() {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this] { return n_legs == 0; });
+    }
+};
+
+struct HttpTimingState {
+    std::mutex mutex;
+    HttpTimingStats stats;
+
+    void Add(bool new_connection, double dns, double connect, double tls, double ttfb, double total) {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.requests++;
+        stats.new_connections += new_connection;
+        stats.dns += dns;
+        stats.connect += connect;
+        stats.tls += tls;
+        stats.ttfb += ttfb;
+        stats.total += total;
+    }
+};
+
+static double
+Seconds(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+static void
+LogBatch(const std::vector<HttpBatchResult>& results, std::chrono::steady_clock::time_point t0)
+{
+    int n_ok = 0;
+    double sum = 0.0;
+    for (auto& r : results) {
+        n_ok += r.ok;
+        sum += r.resp.time;
+    }
+
+    LogMsg("Batch: %d of %d requests ok in %0.3f s, sum of request times %0.3f s",
+           n_ok, (int)results.size(), Seconds(t0), sum);
+}
+
+static void
+LogDownload(const HttpResponse& resp)
+{
+    if (resp.content_encoding.empty() || resp.size_wire == 0 || resp.size == 0)
+        LogMsg("Downloaded %d bytes in %0.3f s", (int)resp.size, resp.time);
+    else
+        LogMsg("Downloaded %d bytes, %d on the wire (%s, %0.1f%%) in %0.3f s",
+               (int)resp.size, (int)resp.size_wire, resp.content_encoding.c_str(),
+               100.0 * resp.size_wire / resp.size, resp.time);
+}
+
+std::string
+HttpUrlEncode(const std::string& value)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    std::string res;
+    res.reserve(value.size() * 3);
+    for (unsigned char c : value) {
+        // not isalnum(), that depends on the locale
+        if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+            c == '-' || c == '.' || c == '_' || c == '~') {
+            res.push_back(c);
+        } else {
+            res.push_back('%');
+            res.push_back(hex[c >> 4]);
+            res.push_back(hex[c & 0xf]);
+        }
+    }
+
+    return res;
+}
 
 #if IBM == 1
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 #include <WinHttp.h>
 
-bool
-HttpGet(const std::string& url, std::string& data, int timeout)
+#include <deque>
+#include <map>
+#include <unordered_set>
+#include <vector>
+
+static constexpr int kAsyncWorkers = 4;
+static constexpr int kBatchWorkers = 8;
+
+struct AsyncReq {
+    HttpRequestId id;
+    std::string url;
+    int timeout;
+    std::string data;
+    HttpCallback callback;
+    bool ok;
+};
+
+// WinHttp keeps alive connections within a session and the OS caches DNS
+// and TLS sessions, so we keep the session and the per host connect handles.
+// Async requests are performed by a small pool of worker threads.
+struct HttpClient::Impl {
+    HINTERNET hSession;
+    std::mutex mutex;
+    std::map<std::wstring, HINTERNET> connects;  // key is host:port
+
+    std::mutex async_mutex;      // protects everything below
+    std::condition_variable async_cv;
+    std::deque<std::unique_ptr<AsyncReq>> pending;
+    std::vector<std::unique_ptr<AsyncReq>> completed;
+    std::unordered_set<HttpRequestId> running, cancelled;
+    std::vector<std::thread> workers;
+    bool stop;
+    HttpRequestId next_id;
+    std::atomic<int> n_async;
+
+    HINTERNET Connect(const WCHAR *host, INTERNET_PORT port);
+    HttpRetryState retry;
+    HttpTimingState timing;
+
+    bool Perform(const std::string& url, int timeout, std::string *data, const HttpSink *sink,
+                 const std::vector<std::string> *headers, HttpResponse& resp,
+                 int connect_timeout = 0, const std::atomic<bool> *abort = nullptr);
+    void Worker(HttpClient *client);
+};
+
+static std::wstring
+Widen(const std::string& str)
 {
-    data.clear();
+    std::wstring wstr(str.length() + 1, L'\0');
+    size_t n = 0;
+    mbstowcs_s(&n, wstr.data(), wstr.size(), str.c_str(), _TRUNCATE);
+    wstr.resize(n > 0 ? n - 1 : 0);
+    return wstr;
+}
+
+// return value of a response header or an empty string
+static std::string
+QueryHeader(HINTERNET hRequest, DWORD info_level)
+{
+    WCHAR buffer[512];
+    DWORD len = sizeof(buffer);
+    if (!WinHttpQueryHeaders(hRequest, info_level, WINHTTP_HEADER_NAME_BY_INDEX, buffer, &len,
+                             WINHTTP_NO_HEADER_INDEX))
+        return std::string();
+
+    char str[512];
+    size_t n = 0;
+    wcstombs_s(&n, str, sizeof(str), buffer, _TRUNCATE);
+    return std::string(str);
+}
 
+HINTERNET
+HttpClient::Impl::Connect(const WCHAR *host, INTERNET_PORT port)
+{
+    std::wstring key = std::wstring(host) + L":" + std::to_wstring(port);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = connects.find(key);
+    if (it != connects.end())
+        return it->second;
+
+    HINTERNET hConnect = WinHttpConnect(hSession, host, port, 0);
+    if (hConnect)
+        connects[key] = hConnect;
+    return hConnect;
+}
+
+HttpClient::HttpClient() : impl_(std::make_unique<Impl>())
+{
+    impl_->hSession = WinHttpOpen(L"sbh",
+            WINHTTP_ACCESS_TYPE_DEFAULT_PROXY,
+            WINHTTP_NO_PROXY_NAME,
+            WINHTTP_NO_PROXY_BYPASS, 0);
+
+    if (NULL == impl_->hSession) {
+        LogMsg("Can't open HTTP session: %lu", GetLastError());
+        return;
+    }
+
+    // needs Windows 8.1 or later
+    DWORD flags = WINHTTP_DECOMPRESSION_FLAG_ALL;
+    if (!WinHttpSetOption(impl_->hSession, WINHTTP_OPTION_DECOMPRESSION, &flags, sizeof(flags)))
+        LogMsg("Can't enable decompression: %lu", GetLastError());
+
+    // needs Windows 10 1607 or later, requests to a host are multiplexed over one connection
+    flags = WINHTTP_PROTOCOL_FLAG_HTTP2;
+    if (!WinHttpSetOption(impl_->hSession, WINHTTP_OPTION_ENABLE_HTTP_PROTOCOL, &flags, sizeof(flags)))
+        LogMsg("Can't enable HTTP/2: %lu", GetLastError());
+}
+
+HttpClient::~HttpClient()
+{
+    Stop();
+    impl_->retry.WaitLegs();
+    for (auto& c : impl_->connects)
+        WinHttpCloseHandle(c.second);
+    if (impl_->hSession)
+        WinHttpCloseHandle(impl_->hSession);
+}
+
+bool
+HttpClient::Impl::Perform(const std::string& url, int timeout, std::string *data, const HttpSink *sink,
+                          const std::vector<std::string> *headers, HttpResponse& resp,
+                          int connect_timeout, const std::atomic<bool> *abort)
+{
     DWORD dwSize = 0;
     DWORD dwDownloaded = 0;
+    DWORD dwContentLength = 0;
+    DWORD dwLen = sizeof(dwContentLength);
+    DWORD dwStatus = 0;
+    std::wstring extra_headers;
     BOOL  bResults = FALSE;
-    HINTERNET  hSession = NULL,
-               hConnect = NULL,
+    HINTERNET  hConnect = NULL,
                hRequest = NULL;
 
     int result = false;
+    auto t0 = std::chrono::steady_clock::now();
+    double ttfb = 0.0;
 
     int url_len = url.length();
     WCHAR *url_wc = (WCHAR *)alloca((url_len + 1) * sizeof(WCHAR));
@@ -67,26 +308,14 @@ HttpGet(const std::string& url, std::string& data, int timeout)
 
     char buffer[16 * 1024];
 
-    // Use WinHttpOpen to obtain a session handle.
-    hSession = WinHttpOpen( L"sbh",
-            WINHTTP_ACCESS_TYPE_DEFAULT_PROXY,
-            WINHTTP_NO_PROXY_NAME,
-            WINHTTP_NO_PROXY_BYPASS, 0 );
-
     if (NULL == hSession) {
-        LogMsg("Can't open HTTP session");
+        LogMsg("No HTTP session");
         goto error_out;
     }
 
-    timeout *= 1000;
-    if (! WinHttpSetTimeouts(hSession, timeout, timeout, timeout, timeout)) {
-        LogMsg("can't set timeouts");
-        goto error_out;
-    }
-
-    hConnect = WinHttpConnect(hSession, host_wc, urlComp.nPort, 0);
+    hConnect = Connect(host_wc, urlComp.nPort);
     if (NULL == hConnect) {
-        LogMsg("Can't open HTTP session");
+        LogMsg("Can't connect: %lu", GetLastError());
         goto error_out;
     }
 
@@ -98,7 +327,21 @@ HttpGet(const std::string& url, std::string& data, int timeout)
         goto error_out;
     }
 
-    bResults = WinHttpSendRequest(hRequest, WINHTTP_NO_ADDITIONAL_HEADERS, 0,
+    timeout *= 1000;
+    connect_timeout = (connect_timeout > 0) ? connect_timeout * 1000 : timeout;
+    if (! WinHttpSetTimeouts(hRequest, connect_timeout, connect_timeout, timeout, timeout)) {
+        LogMsg("can't set timeouts");
+        goto error_out;
+    }
+
+    if (headers) {
+        for (auto& h : *headers)
+            extra_headers += Widen(h) + L"\r\n";
+    }
+
+    bResults = WinHttpSendRequest(hRequest,
+                                  extra_headers.empty() ? WINHTTP_NO_ADDITIONAL_HEADERS : extra_headers.c_str(),
+                                  extra_headers.empty() ? 0 : (DWORD)-1L,
                                   WINHTTP_NO_REQUEST_DATA, 0, 0, 0);
     if (! bResults) {
         LogMsg("Can't send HTTP request: %lu", GetLastError());
@@ -110,6 +353,29 @@ HttpGet(const std::string& url, std::string& data, int timeout)
         LogMsg("Can't receive response: %lu", GetLastError());
         goto error_out;
     }
+    ttfb = Seconds(t0);
+
+    dwLen = sizeof(dwStatus);
+    if (WinHttpQueryHeaders(hRequest, WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER,
+                            WINHTTP_HEADER_NAME_BY_INDEX, &dwStatus, &dwLen, WINHTTP_NO_HEADER_INDEX))
+        resp.status = dwStatus;
+
+    resp.etag = QueryHeader(hRequest, WINHTTP_QUERY_ETAG);
+    resp.last_modified = QueryHeader(hRequest, WINHTTP_QUERY_LAST_MODIFIED);
+    resp.cache_control = QueryHeader(hRequest, WINHTTP_QUERY_CACHE_CONTROL);
+    resp.content_encoding = QueryHeader(hRequest, WINHTTP_QUERY_CONTENT_ENCODING);
+
+    // presize a contiguous buffer
+    dwLen = sizeof(dwContentLength);
+    if (data && WinHttpQueryHeaders(hRequest, WINHTTP_QUERY_CONTENT_LENGTH | WINHTTP_QUERY_FLAG_NUMBER,
+                                    WINHTTP_HEADER_NAME_BY_INDEX, &dwContentLength, &dwLen,
+                                    WINHTTP_NO_HEADER_INDEX)
+        && dwContentLength <= kMaxPresize)
+        data->reserve(dwContentLength);
+
+    // with compression Content-Length is the size on the wire
+    if (!resp.content_encoding.empty())
+        resp.size_wire = dwContentLength;
 
     while (1) {
         DWORD res = WinHttpQueryDataAvailable(hRequest, &dwSize);
@@ -118,11 +384,17 @@ HttpGet(const std::string& url, std::string& data, int timeout)
             goto error_out;
         }
 
-        // LogMsg("dwSize %d", dwSize);
+        LogTrace("dwSize %lu", dwSize);
         if (0 == dwSize) {
             break;
         }
 
+        // a blocking call can't be interrupted, so abort is checked between reads
+        if (abort && abort->load()) {
+            LogMsg("transfer aborted");
+            goto error_out;
+        }
+
         while (dwSize > 0) {
             int get_len = (dwSize < sizeof(buffer) ? dwSize : sizeof(buffer));
 
@@ -132,68 +404,986 @@ HttpGet(const std::string& url, std::string& data, int timeout)
                goto error_out;
             }
 
-            data.append(buffer, dwDownloaded);
+            if (sink) {
+                if (!(*sink)(buffer, dwDownloaded)) {
+                    LogMsg("transfer aborted by sink");
+                    goto error_out;
+                }
+            } else {
+                data->append(buffer, dwDownloaded);
+            }
+            resp.size += dwDownloaded;
             dwSize -= dwDownloaded;
         }
     }
 
+    resp.time = Seconds(t0);
+    LogDownload(resp);
+    timing.Add(false, 0.0, 0.0, 0.0, ttfb, resp.time);
     result = true;
 
 error_out:
-    // Close any open handles.
+    // The connect handle is kept for reuse
     if (hRequest) WinHttpCloseHandle(hRequest);
-    if (hConnect) WinHttpCloseHandle(hConnect);
-    if (hSession) WinHttpCloseHandle(hSession);
 
-    //LogMsg("HttpGet result: %d", result);
+    LogDebug("HttpGet result: %d", result);
     return result;
 }
 
+void
+HttpClient::Impl::Worker(HttpClient *client)
+{
+    std::unique_lock<std::mutex> lock(async_mutex);
+    for (;;) {
+        async_cv.wait(lock, [this] { return stop || !pending.empty(); });
+        if (stop)
+            return;
+
+        auto req = std::move(pending.front());
+        pending.pop_front();
+        running.insert(req->id);
+
+        lock.unlock();
+        req->ok = client->Get(req->url, req->data, req->timeout);
+        lock.lock();
+
+        if (cancelled.erase(req->id) == 0) {
+            running.erase(req->id);
+            completed.push_back(std::move(req));
+        }
+    }
+}
+
+HttpRequestId
+HttpClient::GetAsync(const std::string& url, HttpCallback callback, int timeout)
+{
+    auto req = std::make_unique<AsyncReq>();
+    req->url = url;
+    req->timeout = timeout;
+    req->callback = std::move(callback);
+
+    std::lock_guard<std::mutex> lock(impl_->async_mutex);
+    req->id = ++impl_->next_id;
+    if (req->id <= 0)
+        req->id = impl_->next_id = 1;
+
+    HttpRequestId id = req->id;
+    impl_->pending.push_back(std::move(req));
+    int n = ++impl_->n_async;
+
+    if ((int)impl_->workers.size() < kAsyncWorkers && (int)impl_->workers.size() < n)
+        impl_->workers.emplace_back(&HttpClient::Impl::Worker, impl_.get(), this);
+
+    impl_->async_cv.notify_one();
+    return id;
+}
+
+int
+HttpClient::Poll()
+{
+    if (impl_->n_async.load(std::memory_order_relaxed) == 0)
+        return 0;
+
+    std::vector<std::unique_ptr<AsyncReq>> done;
+    int n_left;
+    {
+        std::lock_guard<std::mutex> lock(impl_->async_mutex);
+        done.swap(impl_->completed);
+        n_left = impl_->n_async -= done.size();
+    }
+
+    for (auto& req : done)
+        req->callback(req->ok, req->data);
+
+    return n_left;
+}
+
+void
+HttpClient::Cancel(HttpRequestId id)
+{
+    std::lock_guard<std::mutex> lock(impl_->async_mutex);
+    auto& pending = impl_->pending;
+    for (auto it = pending.begin(); it != pending.end(); it++) {
+        if ((*it)->id == id) {
+            pending.erase(it);
+            impl_->n_async--;
+            return;
+        }
+    }
+
+    // a running request can't be aborted, its result is discarded
+    if (impl_->running.erase(id)) {
+        impl_->cancelled.insert(id);
+        impl_->n_async--;
+        return;
+    }
+
+    for (auto it = impl_->completed.begin(); it != impl_->completed.end(); it++) {
+        if ((*it)->id == id) {
+            impl_->completed.erase(it);
+            impl_->n_async--;
+            return;
+        }
+    }
+}
+
+// Running requests are finished before the workers terminate.
+void
+HttpClient::Stop()
+{
+    std::vector<std::thread> workers;
+    {
+        std::lock_guard<std::mutex> lock(impl_->async_mutex);
+        impl_->stop = true;
+        impl_->pending.clear();
+        impl_->completed.clear();
+        impl_->cancelled.insert(impl_->running.begin(), impl_->running.end());
+        impl_->running.clear();
+        impl_->n_async = 0;
+        workers.swap(impl_->workers);
+    }
+
+    impl_->async_cv.notify_all();
+    for (auto& w : workers)
+        w.join();
+
+    std::lock_guard<std::mutex> lock(impl_->async_mutex);
+    impl_->cancelled.clear();
+    impl_->stop = false;
+}
+
+// host:port part of an url
+static std::string
+HostOf(const std::string& url)
+{
+    size_t start = url.find("://");
+    start = (start == std::string::npos) ? 0 : start + 3;
+    size_t end = url.find_first_of("/?#", start);
+    return url.substr(start, end == std::string::npos ? std::string::npos : end - start);
+}
+
+// WinHttp has no multi interface so the batch is performed by a set of threads.
+// A thread picks the next url whose host is below the connection limit.
+bool
+HttpClient::GetBatch(const std::vector<std::string>& urls, std::vector<HttpBatchResult>& results,
+                     int timeout, int max_per_host)
+{
+    TraceSpan("HttpGetBatch");
+    auto t0 = std::chrono::steady_clock::now();
+    results.clear();
+    results.resize(urls.size());
+
+    int n = urls.size();
+    std::vector<std::string> hosts(n);
+    std::vector<bool> started(n);
+    for (int i = 0; i < n; i++)
+        hosts[i] = HostOf(urls[i]);
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::map<std::string, int> active;
+    int n_started = 0;
+
+    auto worker = [&] {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            int i = -1;
+            cv.wait(lock, [&] {
+                if (n_started == n)
+                    return true;
+                for (int j = 0; j < n; j++)
+                    if (!started[j] && active[hosts[j]] < max_per_host) {
+                        i = j;
+                        return true;
+                    }
+                return false;
+            });
+
+            if (i < 0)
+                return;
+
+            started[i] = true;
+            n_started++;
+            active[hosts[i]]++;
+            lock.unlock();
+
+            auto& r = results[i];
+            r.ok = impl_->Perform(urls[i], timeout, &r.data, nullptr, nullptr, r.resp);
+            if (!r.ok)
+                LogMsg("batch request '%s' failed", urls[i].c_str());
+
+            lock.lock();
+            active[hosts[i]]--;
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    int n_threads = std::min(n, kBatchWorkers);
+    for (int i = 0; i < n_threads; i++)
+        threads.emplace_back(worker);
+    for (auto& t : threads)
+        t.join();
+
+    LogBatch(results, t0);
+    for (auto& r : results)
+        if (!r.ok)
+            return false;
+    return true;
+}
+
 #else   // Linux or MacOS
 #include <curl/curl.h>
+
+#include <strings.h>
+
+#include <string_view>
+#include <unordered_map>
+
+// destination of a transfer, either a contiguous buffer or a sink
+struct Transfer {
+    CURL *curl;
+    std::string *data;
+    const HttpSink *sink;
+    bool started;
+    HttpResponse *resp;
+    size_t size;
+};
+
+struct AsyncReq {
+    HttpRequestId id;
+    CURL *curl;
+    std::string data;
+    Transfer xfer;
+    HttpCallback callback;
+    bool ok;
+};
+
+// Easy handles keep their connections alive, idle ones are pooled.
+// In addition all handles share DNS cache and TLS sessions. The connection cache is not
+// shared: libcurl does not allow to use it from concurrent threads, so each easy handle
+// (or multi handle) has its own.
+// Async requests are driven by a multi handle from Poll().
+struct HttpClient::Impl {
+    CURLSH *share;
+    std::mutex share_mutex[CURL_LOCK_DATA_LAST];
+
+    std::mutex mutex;
+    std::vector<CURL *> idle;
+
+    std::mutex async_mutex;      // protects everything below
+    CURLM *multi;
+    HttpRequestId next_id;
+    std::unordered_map<HttpRequestId, std::unique_ptr<AsyncReq>> async_reqs;
+    std::atomic<int> n_async;
+
+    CURL *Acquire();
+    void Release(CURL *curl);
+    HttpRetryState retry;
+    HttpTimingState timing;
+
+    bool Perform(const std::string& url, int timeout, std::string *data, const HttpSink *sink,
+                 const std::vector<std::string> *headers, HttpResponse& resp,
+                 int connect_timeout = 0, const std::atomic<bool> *abort = nullptr);
+};
+
+static void
+share_lock(CURL *, curl_lock_data data, curl_lock_access, void *userptr)
+{
+    static_cast<std::mutex *>(userptr)[data].lock();
+}
+
+static void
+share_unlock(CURL *, curl_lock_data data, void *userptr)
+{
+    static_cast<std::mutex *>(userptr)[data].unlock();
+}
+
+CURL *
+HttpClient::Impl::Acquire()
+{
+    CURL *curl = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!idle.empty()) {
+            curl = idle.back();
+            idle.pop_back();
+        }
+    }
+
+    if (curl)
+        curl_easy_reset(curl);      // keeps connections and caches
+    else
+        curl = curl_easy_init();
+
+    if (curl) {
+        curl_easy_setopt(curl, CURLOPT_SHARE, share);
+        curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(curl, CURLOPT_DNS_CACHE_TIMEOUT, 300L);
+    }
+
+    return curl;
+}
+
+void
+HttpClient::Impl::Release(CURL *curl)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    idle.push_back(curl);
+}
+
+HttpClient::HttpClient() : impl_(std::make_unique<Impl>())
+{
+    // curl_global_init is not thread safe, so do it once and never clean up
+    static std::once_flag init_flag;
+    std::call_once(init_flag, [] { curl_global_init(CURL_GLOBAL_ALL); });
+
+    CURLSH *share = impl_->share = curl_share_init();
+    curl_share_setopt(share, CURLSHOPT_LOCKFUNC, share_lock);
+    curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, share_unlock);
+    curl_share_setopt(share, CURLSHOPT_USERDATA, impl_->share_mutex);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+}
+
+HttpClient::~HttpClient()
+{
+    Stop();
+    impl_->retry.WaitLegs();
+    if (impl_->multi)
+        curl_multi_cleanup(impl_->multi);
+
+    for (auto curl : impl_->idle)
+        curl_easy_cleanup(curl);
+    curl_share_cleanup(impl_->share);
+}
+
 static size_t
 write_cb(const void *ptr, size_t size, size_t nmemb, void *userdata)
 {
     auto len = size * nmemb;
-    std::string *data = static_cast<std::string *>(userdata);
-    data->append((const char *)ptr, len);
+    Transfer *xfer = static_cast<Transfer *>(userdata);
+    xfer->size += len;
+
+    if (xfer->sink)
+        return (*xfer->sink)((const char *)ptr, len) ? len : 0;   // 0 aborts the transfer
+
+    // presize a contiguous buffer, headers are complete when the first chunk arrives
+    if (!xfer->started) {
+        xfer->started = true;
+        curl_off_t cl;
+        if (curl_easy_getinfo(xfer->curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &cl) == CURLE_OK
+            && cl > 0 && cl <= kMaxPresize)
+            xfer->data->reserve(cl);
+    }
+
+    xfer->data->append((const char *)ptr, len);
     return len;
 }
 
-bool
-HttpGet(const std::string& url, std::string& data, int timeout)
+static int
+xferinfo_cb(void *userdata, curl_off_t, curl_off_t, curl_off_t, curl_off_t)
 {
-    CURL *curl;
-    CURLcode res;
-    curl_global_init(CURL_GLOBAL_ALL);
-    curl = curl_easy_init();
-    if(curl == NULL)
-        return 0;
+    return static_cast<const std::atomic<bool> *>(userdata)->load() ? 1 : 0;   // != 0 aborts
+}
+
+static size_t
+header_cb(char *buffer, size_t size, size_t nitems, void *userdata)
+{
+    auto len = size * nitems;
+    HttpResponse *resp = static_cast<HttpResponse *>(userdata);
+
+    std::string_view line(buffer, len);
+    if (line.substr(0, 5) == "HTTP/") {
+        *resp = HttpResponse();     // a new response, e.g. after a redirect
+        return len;
+    }
+
+    auto colon = line.find(':');
+    if (colon == line.npos)
+        return len;
+
+    std::string_view name = line.substr(0, colon);
+    std::string_view value = line.substr(colon + 1);
+    while (!value.empty() && isspace((unsigned char)value.front()))
+        value.remove_prefix(1);
+    while (!value.empty() && isspace((unsigned char)value.back()))
+        value.remove_suffix(1);
+
+    auto is = [name](const char *h) {
+        return name.size() == strlen(h) && strncasecmp(name.data(), h, name.size()) == 0;
+    };
+
+    if (is("etag"))
+        resp->etag = value;
+    else if (is("last-modified"))
+        resp->last_modified = value;
+    else if (is("cache-control"))
+        resp->cache_control = value;
+    else if (is("content-encoding"))
+        resp->content_encoding = value;
+
+    return len;
+}
+
+// add timing of a completed transfer
+static void
+AddTiming(HttpTimingState& timing, CURL *curl)
+{
+    // times are in us and cumulative since the start of the transfer
+    curl_off_t dns = 0, connect = 0, tls = 0, ttfb = 0, total = 0;
+    long n_connects = 0;
+    curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME_T, &dns);
+    curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connect);
+    curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME_T, &tls);
+    curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &ttfb);
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total);
+    curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &n_connects);
 
+    // APPCONNECT is 0 for plain http
+    timing.Add(n_connects > 0, dns * 1.0E-6, std::max<curl_off_t>(connect - dns, 0) * 1.0E-6,
+               std::max<curl_off_t>(tls - connect, 0) * 1.0E-6, ttfb * 1.0E-6, total * 1.0E-6);
+}
+
+static void
+SetupGet(CURL *curl, const std::string& url, int timeout, Transfer *xfer)
+{
+    xfer->curl = curl;
+    xfer->started = false;
     curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, timeout);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)timeout);
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_cb);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&data);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)xfer);
 
     curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
     curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-    res = curl_easy_perform(curl);
+
+    // "" = all encodings libcurl was built with
+    curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+}
+
+bool
+HttpClient::Impl::Perform(const std::string& url, int timeout, std::string *data, const HttpSink *sink,
+                          const std::vector<std::string> *headers, HttpResponse& resp,
+                          int connect_timeout, const std::atomic<bool> *abort)
+{
+    CURL *curl = Acquire();
+    if (curl == NULL)
+        return false;
+
+    auto t0 = std::chrono::steady_clock::now();
+    Transfer xfer{curl, data, sink, false, &resp, 0};
+    SetupGet(curl, url, timeout, &xfer);
+
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, header_cb);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, (void *)&resp);
+
+    if (connect_timeout > 0)
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, (long)connect_timeout);
+
+    if (abort) {
+        curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, xferinfo_cb);
+        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, (void *)abort);
+        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+    }
+
+    struct curl_slist *hdr_list = nullptr;
+    if (headers) {
+        for (auto& h : *headers)
+            hdr_list = curl_slist_append(hdr_list, h.c_str());
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, hdr_list);
+    }
+
+    CURLcode res = curl_easy_perform(curl);
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &resp.status);
+    curl_slist_free_all(hdr_list);
 
     // Check for errors
     if(res != CURLE_OK) {
-        LogMsg("curl_easy_perform() failed: %s\n", curl_easy_strerror(res));
-        curl_easy_cleanup(curl);
-        curl_global_cleanup();
+        LogMsg("curl_easy_perform() failed: %s", curl_easy_strerror(res));
+        Release(curl);
         return false;
     }
 
+    // SIZE_DOWNLOAD is counted before decoding
     curl_off_t dl_size;
     res = curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T , &dl_size);
     if(res == CURLE_OK)
-        LogMsg("Downloaded %d bytes", (int)dl_size);
+        resp.size_wire = dl_size;
 
-    curl_easy_cleanup(curl);
-    curl_global_cleanup();
+    resp.size = xfer.size;
+    resp.time = Seconds(t0);
+    LogDownload(resp);
+    AddTiming(timing, curl);
+
+    Release(curl);
+    return true;
+}
+
+HttpRequestId
+HttpClient::GetAsync(const std::string& url, HttpCallback callback, int timeout)
+{
+    CURL *curl = impl_->Acquire();
+    if (curl == NULL)
+        return 0;
+
+    auto req = std::make_unique<AsyncReq>();
+    req->curl = curl;
+    req->callback = std::move(callback);
+    req->xfer.data = &req->data;
+    SetupGet(curl, url, timeout, &req->xfer);
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, (void *)req.get());
+
+    std::lock_guard<std::mutex> lock(impl_->async_mutex);
+    if (impl_->multi == nullptr)
+        impl_->multi = curl_multi_init();
+
+    CURLMcode mres = curl_multi_add_handle(impl_->multi, curl);
+    if (mres != CURLM_OK) {
+        LogMsg("curl_multi_add_handle() failed: %s", curl_multi_strerror(mres));
+        impl_->Release(curl);
+        return 0;
+    }
+
+    req->id = ++impl_->next_id;
+    if (req->id <= 0)
+        req->id = impl_->next_id = 1;
+
+    HttpRequestId id = req->id;
+    impl_->async_reqs[id] = std::move(req);
+    impl_->n_async++;
+    return id;
+}
+
+int
+HttpClient::Poll()
+{
+    if (impl_->n_async.load(std::memory_order_relaxed) == 0)
+        return 0;
+
+    std::vector<std::unique_ptr<AsyncReq>> done;
+    int n_left;
+    {
+        std::lock_guard<std::mutex> lock(impl_->async_mutex);
+        int running;
+        curl_multi_perform(impl_->multi, &running);
+
+        CURLMsg *msg;
+        int n_msg;
+        while ((msg = curl_multi_info_read(impl_->multi, &n_msg))) {
+            if (msg->msg != CURLMSG_DONE)
+                continue;
+
+            AsyncReq *req;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&req);
+            req->ok = (msg->data.result == CURLE_OK);
+            if (req->ok)
+                AddTiming(impl_->timing, req->curl);
+            else
+                LogMsg("async request failed: %s", curl_easy_strerror(msg->data.result));
+
+            curl_multi_remove_handle(impl_->multi, req->curl);
+            auto it = impl_->async_reqs.find(req->id);
+            done.push_back(std::move(it->second));
+            impl_->async_reqs.erase(it);
+        }
+
+        n_left = impl_->n_async -= done.size();
+    }
+
+    // callbacks may start new requests, so call them without holding the lock
+    for (auto& req : done) {
+        impl_->Release(req->curl);
+        req->callback(req->ok, req->data);
+    }
+
+    return n_left;
+}
+
+void
+HttpClient::Cancel(HttpRequestId id)
+{
+    std::lock_guard<std::mutex> lock(impl_->async_mutex);
+    auto it = impl_->async_reqs.find(id);
+    if (it == impl_->async_reqs.end())
+        return;
+
+    curl_multi_remove_handle(impl_->multi, it->second->curl);
+    impl_->Release(it->second->curl);
+    impl_->async_reqs.erase(it);
+    impl_->n_async--;
+}
+
+void
+HttpClient::Stop()
+{
+    std::lock_guard<std::mutex> lock(impl_->async_mutex);
+    for (auto& r : impl_->async_reqs) {
+        curl_multi_remove_handle(impl_->multi, r.second->curl);
+        impl_->Release(r.second->curl);
+    }
+
+    impl_->async_reqs.clear();
+    impl_->n_async = 0;
+}
+
+// All transfers of the batch are driven by a private multi handle,
+// pooled easy handles are used as for Get(), connections are cached by the multi handle.
+bool
+HttpClient::GetBatch(const std::vector<std::string>& urls, std::vector<HttpBatchResult>& results,
+                     int timeout, int max_per_host)
+{
+    TraceSpan("HttpGetBatch");
+    auto t0 = std::chrono::steady_clock::now();
+    results.clear();
+    results.resize(urls.size());
+
+    CURLM *multi = curl_multi_init();
+    if (multi == NULL)
+        return false;
+
+    curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)max_per_host);
+
+    std::vector<Transfer> xfers(urls.size());
+    for (size_t i = 0; i < urls.size(); i++) {
+        auto& r = results[i];
+        CURL *curl = impl_->Acquire();
+        if (curl == NULL)
+            continue;
+
+        xfers[i] = {curl, &r.data, nullptr, false, &r.resp, 0};
+        SetupGet(curl, urls[i], timeout, &xfers[i]);
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, header_cb);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, (void *)&r.resp);
+        curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+
+        // rather wait for a connection that can be multiplexed than open a new one
+        curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+        curl_easy_setopt(curl, CURLOPT_PRIVATE, (void *)&xfers[i]);
+
+        CURLMcode mres = curl_multi_add_handle(multi, curl);
+        if (mres != CURLM_OK) {
+            LogMsg("curl_multi_add_handle() failed: %s", curl_multi_strerror(mres));
+            impl_->Release(curl);
+            xfers[i].curl = nullptr;
+        }
+    }
+
+    int running;
+    do {
+        CURLMcode mres = curl_multi_perform(multi, &running);
+        if (mres == CURLM_OK && running)
+            mres = curl_multi_poll(multi, NULL, 0, 1000, NULL);
+
+        if (mres != CURLM_OK) {
+            LogMsg("batch failed: %s", curl_multi_strerror(mres));
+            break;
+        }
+
+        CURLMsg *msg;
+        int n_msg;
+        while ((msg = curl_multi_info_read(multi, &n_msg))) {
+            if (msg->msg != CURLMSG_DONE)
+                continue;
+
+            Transfer *xfer;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&xfer);
+            size_t i = xfer - xfers.data();
+            auto& r = results[i];
+            CURL *curl = xfer->curl;
+
+            r.ok = (msg->data.result == CURLE_OK);
+            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &r.resp.status);
+            if (r.ok) {
+                curl_off_t val;
+                if (curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &val) == CURLE_OK)
+                    r.resp.size_wire = val;
+                if (curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &val) == CURLE_OK)
+                    r.resp.time = val * 1.0E-6;
+                r.resp.size = xfer->size;
+                LogDownload(r.resp);
+                AddTiming(impl_->timing, curl);
+            } else {
+                LogMsg("batch request '%s' failed: %s", urls[i].c_str(), curl_easy_strerror(msg->data.result));
+            }
+
+            curl_multi_remove_handle(multi, curl);
+            impl_->Release(curl);
+            xfer->curl = nullptr;
+        }
+    } while (running);
+
+    // leftovers after an error
+    for (auto& x : xfers)
+        if (x.curl) {
+            curl_multi_remove_handle(multi, x.curl);
+            impl_->Release(x.curl);
+        }
+
+    curl_multi_cleanup(multi);
+
+    LogBatch(results, t0);
+    for (auto& r : results)
+        if (!r.ok)
+            return false;
     return true;
 }
 #endif
+
+bool
+HttpClient::Get(const std::string& url, std::string& data, int timeout)
+{
+    TraceSpan("HttpGet");
+    data.clear();
+    HttpResponse resp;
+    return impl_->Perform(url, timeout, &data, nullptr, nullptr, resp);
+}
+
+bool
+HttpClient::Get(const std::string& url, const HttpSink& sink, int timeout, const std::atomic<bool> *abort)
+{
+    TraceSpan("HttpGet");
+    HttpResponse resp;
+    return impl_->Perform(url, timeout, nullptr, &sink, nullptr, resp, 0, abort);
+}
+
+bool
+HttpClient::Get(const std::string& url, std::string& data, int timeout,
+                const std::vector<std::string>& headers, HttpResponse& resp)
+{
+    TraceSpan("HttpGet");
+    data.clear();
+    resp = HttpResponse();
+    return impl_->Perform(url, timeout, &data, nullptr, &headers, resp);
+}
+
+// A request and its hedge run as detached legs, the first acceptable result wins.
+struct HttpLeg {
+    std::string data;
+    HttpResponse resp{};
+    bool ok{false};
+    bool done{false};
+    std::atomic<bool> abort{false};
+    std::chrono::steady_clock::time_point t0;
+    double time{0.0};
+};
+
+struct HttpRace {
+    std::mutex mutex;
+    std::condition_variable cv;
+    HttpLeg leg[2];
+};
+
+static inline bool
+Acceptable(bool ok, const HttpResponse& resp)
+{
+    return ok && resp.status < 500 && resp.status != 429;
+}
+
+bool
+HttpClient::Get(const std::string& url, std::string& data, const HttpRetryPolicy& policy,
+                std::vector<HttpAttempt> *attempts)
+{
+    TraceSpan("HttpGetRetry");
+    using clock = std::chrono::steady_clock;
+    static thread_local std::mt19937 rng{std::random_device{}()};
+
+    Impl *impl = impl_.get();
+    HttpRetryState& rs = impl->retry;
+    auto deadline = clock::now() + std::chrono::seconds(policy.deadline);
+
+    bool ok = false, acceptable = false;
+    int n_attempts = 0, n_hedges = 0, n_hedge_wins = 0;
+    data.clear();
+
+    for (int attempt = 1; attempt <= policy.max_attempts; attempt++) {
+        if (attempt > 1) {
+            float delay = std::min(policy.backoff * (float)(1 << std::min(attempt - 2, 20)), policy.max_backoff);
+            delay -= delay * policy.jitter * std::uniform_real_distribution<float>(0.0f, 1.0f)(rng);
+            auto until = clock::now() + std::chrono::duration<float>(delay);
+            if (until >= deadline)
+                break;
+            std::this_thread::sleep_until(until);
+        }
+
+        double remaining = std::chrono::duration<double>(deadline - clock::now()).count();
+        if (remaining <= 0.0)
+            break;
+        int timeout = std::min(policy.timeout, (int)ceil(remaining));
+
+        double p95 = 0.0;
+        if (policy.hedge) {
+            std::lock_guard<std::mutex> lock(rs.mutex);
+            p95 = rs.P95(policy.hedge_min_samples);
+        }
+
+        std::vector<HttpAttempt> outcome;
+
+        if (p95 == 0.0) {
+            // no hedging, perform inline
+            auto t0 = clock::now();
+            HttpResponse resp{};
+            std::string buffer;
+            ok = impl->Perform(url, timeout, &buffer, nullptr, nullptr, resp, policy.connect_timeout);
+            double t = std::chrono::duration<double>(clock::now() - t0).count();
+            acceptable = Acceptable(ok, resp);
+            outcome.push_back({attempt, false, acceptable, resp.status, t});
+            data = std::move(buffer);
+        } else {
+            auto race = std::make_shared<HttpRace>();
+            int connect_timeout = policy.connect_timeout;
+
+            auto start_leg = [&](int i) {
+                {
+                    std::lock_guard<std::mutex> lock(rs.mutex);
+                    rs.n_legs++;
+                }
+
+                race->leg[i].t0 = clock::now();
+                std::thread([impl, race, i, url, timeout, connect_timeout] {
+                    HttpLeg& leg = race->leg[i];
+                    bool ok = impl->Perform(url, timeout, &leg.data, nullptr, nullptr, leg.resp,
+                                            connect_timeout, &leg.abort);
+                    {
+                        std::lock_guard<std::mutex> lock(race->mutex);
+                        leg.ok = ok;
+                        leg.time = std::chrono::duration<double>(clock::now() - leg.t0).count();
+                        leg.done = true;
+                    }
+                    race->cv.notify_all();
+
+                    // impl may be gone as soon as the lock is released
+                    std::lock_guard<std::mutex> lock(impl->retry.mutex);
+                    if (--impl->retry.n_legs == 0)
+                        impl->retry.cv.notify_all();
+                }).detach();
+            };
+
+            std::unique_lock<std::mutex> lock(race->mutex);
+            HttpLeg *legs = race->leg;
+            start_leg(0);
+            int n_legs = 1;
+            if (!race->cv.wait_for(lock, std::chrono::duration<double>(std::min(p95, (double)timeout)),
+                                   [legs] { return legs[0].done; })
+                && clock::now() < deadline) {
+                start_leg(1);
+                n_legs = 2;
+                n_hedges++;
+            }
+
+            int winner = -1;
+            race->cv.wait(lock, [&] {
+                bool all_done = true;
+                for (int i = 0; i < n_legs; i++) {
+                    if (legs[i].done && Acceptable(legs[i].ok, legs[i].resp)) {
+                        winner = i;
+                        return true;
+                    }
+                    all_done = all_done && legs[i].done;
+                }
+                return all_done;
+            });
+
+            if (winner < 0)
+                winner = 0;
+            if (winner == 1)
+                n_hedge_wins++;
+
+            for (int i = 0; i < n_legs; i++) {
+                HttpLeg& leg = legs[i];
+                if (leg.done) {
+                    outcome.push_back({attempt, i == 1, Acceptable(leg.ok, leg.resp), leg.resp.status, leg.time});
+                } else {
+                    leg.abort = true;
+                    outcome.push_back({attempt, i == 1, false, 0,
+                                       std::chrono::duration<double>(clock::now() - leg.t0).count()});
+                }
+            }
+
+            ok = legs[winner].ok;
+            acceptable = Acceptable(ok, legs[winner].resp);
+            data = std::move(legs[winner].data);
+        }
+
+        n_attempts += outcome.size();
+        {
+            std::lock_guard<std::mutex> lock(rs.mutex);
+            for (auto& o : outcome)
+                if (o.ok)
+                    rs.AddSample(o.time);
+        }
+
+        if (attempts)
+            attempts->insert(attempts->end(), outcome.begin(), outcome.end());
+
+        if (acceptable)
+            break;
+
+        LogMsg("attempt %d of '%s' failed, status: %ld", attempt, url.c_str(), outcome[0].status);
+    }
+
+    std::lock_guard<std::mutex> lock(rs.mutex);
+    HttpRetryStats& st = rs.stats;
+    st.requests++;
+    st.attempts += n_attempts;
+    st.retries += std::max(0, n_attempts - n_hedges - 1);
+    st.hedges += n_hedges;
+    st.hedge_wins += n_hedge_wins;
+    if (!acceptable)
+        st.failures++;
+    return ok;
+}
+
+HttpRetryStats
+HttpClient::RetryStats() const
+{
+    HttpRetryState& rs = impl_->retry;
+    std::lock_guard<std::mutex> lock(rs.mutex);
+    HttpRetryStats st = rs.stats;
+    st.p95 = rs.P95(1);
+    return st;
+}
+
+void
+HttpClient::LogRetryStats() const
+{
+    HttpRetryStats st = RetryStats();
+    LogMsg("HttpClient: requests: %u, attempts: %u, retries: %u, hedges: %u, hedge wins: %u, "
+           "failures: %u, p95: %0.3f s",
+           st.requests, st.attempts, st.retries, st.hedges, st.hedge_wins, st.failures, st.p95);
+}
+
+HttpTimingStats
+HttpClient::TimingStats() const
+{
+    std::lock_guard<std::mutex> lock(impl_->timing.mutex);
+    return impl_->timing.stats;
+}
+
+void
+HttpClient::LogTimingStats() const
+{
+    HttpTimingStats st = TimingStats();
+    if (st.requests == 0)
+        return;
+
+    // averages in ms
+    double f = 1000.0 / st.requests;
+    LogMsg("HttpClient: requests: %u, new connections: %u, avg dns: %0.1f, connect: %0.1f, tls: %0.1f, "
+           "ttfb: %0.1f, total: %0.1f ms",
+           st.requests, st.new_connections, st.dns * f, st.connect * f, st.tls * f, st.ttfb * f, st.total * f);
+}
+
+HttpClient&
+HttpDefaultClient()
+{
+    static HttpClient client;
+    return client;
+}
+
+bool
+HttpGet(const std::string& url, std::string& data, int timeout)
+{
+    return HttpDefaultClient().Get(url, data, timeout);
+}
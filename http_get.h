@@ -20,9 +20,153 @@
 #ifndef _HTTP_GET_
 #define _HTTP_GET_
 
+#include <atomic>
+#include <functional>
+#include <memory>
 #include <string>
+#include <vector>
+
+// details of a response
+struct HttpResponse {
+    long status;            // HTTP status, 0 if none was received
+    std::string etag;
+    std::string last_modified;
+    std::string cache_control;
+    std::string content_encoding;
+    size_t size;            // size of the (decoded) body
+    size_t size_wire;       // size on the wire, 0 if unknown
+    double time;            // total time in s
+};
+
+// result of one url of a batch
+struct HttpBatchResult {
+    bool ok;
+    std::string data;
+    HttpResponse resp;      // resp.time is the time of this request
+};
+
+// Retry and hedging policy, times are in seconds
+struct HttpRetryPolicy {
+    int max_attempts = 3;
+    float backoff = 0.2f;           // delay before the 2nd attempt, doubled for each further one
+    float max_backoff = 5.0f;
+    float jitter = 0.5f;            // up to this fraction of the delay is randomly skipped
+    int connect_timeout = 10;
+    int timeout = 30;               // of a single attempt
+    int deadline = 60;              // of all attempts including delays
+    bool hedge = false;             // start a second request if the first exceeds the p95 latency
+    int hedge_min_samples = 20;     // # of latency samples before hedging starts
+};
+
+// outcome of a single attempt
+// a hedge leg that lost the race is recorded as not ok with the time until it was aborted
+struct HttpAttempt {
+    int attempt;            // 1 based
+    bool hedge;
+    bool ok;                // transfer succeeded and status is not 5xx or 429
+    long status;
+    double time;
+};
+
+struct HttpRetryStats {
+    unsigned requests;
+    unsigned attempts;      // including hedges
+    unsigned retries;
+    unsigned hedges;
+    unsigned hedge_wins;    // hedge finished first
+    unsigned failures;      // requests that failed after all attempts
+    double p95;             // current latency estimate in s, 0 if unknown
+};
+
+// Timing of completed transfers, sums in s
+// On Windows only ttfb and total are available.
+struct HttpTimingStats {
+    unsigned requests;
+    unsigned new_connections;   // # of requests that could not reuse a connection
+    double dns;                 // name lookup
+    double connect;             // tcp connect
+    double tls;                 // tls handshake
+    double ttfb;                // until the first byte of the response
+    double total;
+};
+
+// completion callback of an async request
+typedef std::function<void(bool ok, std::string& data)> HttpCallback;
+typedef int HttpRequestId;      // 0 is not a valid id
+
+// Receives the body in chunks as they arrive, return false to abort the transfer.
+typedef std::function<bool(const char *data, size_t len)> HttpSink;
+
+// A long lived HTTP client.
+// Connections are kept alive and reused, DNS results and TLS sessions are cached.
+// Compressed transfers (gzip, deflate and br where available) are negotiated and
+// decoded transparently, also for streaming.
+// All functions can be called from any thread.
+class HttpClient {
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+
+  public:
+    HttpClient();
+    ~HttpClient();
+
+    HttpClient(const HttpClient&) = delete;
+    HttpClient& operator=(const HttpClient&) = delete;
+
+    // GET url into data, timeout in seconds
+    // data is presized from Content-Length
+    bool Get(const std::string& url, std::string& data, int timeout);
+
+    // GET url and stream the body into sink, e.g. into an incremental parser or a file
+    // The transfer is aborted as soon as *abort becomes true.
+    bool Get(const std::string& url, const HttpSink& sink, int timeout, const std::atomic<bool> *abort = nullptr);
+
+    // GET with additional request headers ("Name: value") and details of the response
+    bool Get(const std::string& url, std::string& data, int timeout,
+             const std::vector<std::string>& headers, HttpResponse& resp);
+
+    // GET with retries on transport errors, 5xx and 429 according to policy.
+    // The outcome of each attempt is appended to attempts if given.
+    // Returns like Get() the result of the last attempt.
+    bool Get(const std::string& url, std::string& data, const HttpRetryPolicy& policy,
+             std::vector<HttpAttempt> *attempts = nullptr);
+
+    HttpRetryStats RetryStats() const;
+    void LogRetryStats() const;
+
+    // connection setup costs and latency of all requests
+    HttpTimingStats TimingStats() const;
+    void LogTimingStats() const;
+
+    // GET all urls concurrently and wait for completion, results are in order of urls.
+    // At most max_per_host new connections are opened per host, idle ones are reused.
+    // If the server supports HTTP/2 requests to a host are multiplexed over a single connection.
+    // Returns true if all requests succeeded.
+    bool GetBatch(const std::vector<std::string>& urls, std::vector<HttpBatchResult>& results,
+                  int timeout, int max_per_host = 4);
+
+    // Non blocking GET. The transfer progresses in the background or in Poll(),
+    // the callback is always called from Poll().
+    HttpRequestId GetAsync(const std::string& url, HttpCallback callback, int timeout);
+
+    // Drive async transfers and deliver completed ones, call it from a flight loop.
+    // Returns # of requests still in flight. Costs nothing if none is in flight.
+    int Poll();
+
+    // Cancel an async request, its callback is not called.
+    void Cancel(HttpRequestId id);
+
+    // Cancel all async requests and stop background threads, e.g. in XPluginStop.
+    void Stop();
+};
+
+// the client that is used by HttpGet()
+extern HttpClient& HttpDefaultClient();
 
 extern bool HttpGet(const std::string& url, std::string& data, int timeout);
 
+// percent-encode a query parameter value, only unreserved characters (RFC 3986) are kept
+extern std::string HttpUrlEncode(const std::string& value);
+
 #endif
 
@@ -0,0 +1,233 @@
+//
+//    Copyright (C) 2026 Holger Teutsch
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 2.1 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+//    USA
+//
+
+#include <cerrno>
+#include <chrono>
+#include <thread>
+
+#include "log_bin.h"
+#include "log_msg.h"
+
+#if IBM == 1
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+static HANDLE file_h = INVALID_HANDLE_VALUE, map_h;
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+static int fd = -1;
+#endif
+
+std::atomic<bool> log_bin_active;
+std::atomic<uint32_t> log_bin::gen;
+
+static char *map_base;
+static size_t map_size;
+static int64_t t0_ns;
+static std::atomic<uint64_t> used;          // offset of next record
+static std::atomic<unsigned> dropped;
+static std::atomic<int> writers;            // # of threads between Begin and End
+static std::atomic<uint32_t> next_id;
+
+static inline int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static inline size_t RecLen(size_t payload_len) {
+    return (sizeof(LogBinRecHdr) + payload_len + 7) & ~size_t{7};
+}
+
+// reserve a record and return ptr to its payload
+static char *Reserve(uint32_t id, size_t payload_len) {
+    writers.fetch_add(1);
+    if (!log_bin_active.load()) {
+        writers.fetch_sub(1, std::memory_order_release);
+        return nullptr;
+    }
+
+    size_t len = RecLen(payload_len);
+    uint64_t off = used.fetch_add(len, std::memory_order_relaxed);
+    if (off + len > map_size) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        writers.fetch_sub(1, std::memory_order_release);
+        return nullptr;
+    }
+
+    auto rec = reinterpret_cast<LogBinRecHdr *>(map_base + off);
+    rec->id = id;
+    rec->ts = NowNs() - t0_ns;
+    return reinterpret_cast<char *>(rec + 1);
+}
+
+char *log_bin::Begin(LogBinSite& site, size_t payload_len) {
+    return Reserve(site.id.load(std::memory_order_relaxed), payload_len);
+}
+
+void log_bin::End(char *payload, size_t payload_len) {
+    auto rec = reinterpret_cast<LogBinRecHdr *>(payload) - 1;
+    __atomic_store_n(&rec->len, (uint32_t)RecLen(payload_len), __ATOMIC_RELEASE);
+    writers.fetch_sub(1, std::memory_order_release);
+}
+
+void log_bin::Define(LogBinSite& site, const char *types) {
+    uint32_t g = gen.load(std::memory_order_acquire);
+    uint32_t sg = site.gen.load(std::memory_order_relaxed);
+    if (sg == g)
+        return;
+
+    // ids are stable across files, a lost race just wastes an id
+    if (site.id.load(std::memory_order_relaxed) == 0) {
+        uint32_t expected = 0;
+        site.id.compare_exchange_strong(expected, next_id.fetch_add(1) + 1);
+    }
+
+    // only one thread writes the definition into the current file
+    if (!site.gen.compare_exchange_strong(sg, g))
+        return;
+
+    size_t lt = strlen(types) + 1;
+    size_t lf = strlen(site.file) + 1;
+    size_t lm = strlen(site.fmt) + 1;
+    size_t len = 4 + lt + lf + lm;
+
+    char *p = Reserve(site.id.load(std::memory_order_relaxed) | kLogBinDef, len);
+    if (p == nullptr)
+        return;
+
+    char *pl = p;
+    uint32_t line = site.line;
+    memcpy(p, &line, 4);
+    p += 4;
+    memcpy(p, types, lt);
+    p += lt;
+    memcpy(p, site.file, lf);
+    p += lf;
+    memcpy(p, site.fmt, lm);
+    log_bin::End(pl, len);
+}
+
+bool LogBinOpen(const char *path, size_t size) {
+    LogBinClose();
+
+    size &= ~size_t{7};
+    if (size < 64 * 1024)
+        size = 64 * 1024;
+
+#if IBM == 1
+    file_h = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL,
+                         CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file_h == INVALID_HANDLE_VALUE) {
+        LogMsg("Can't create binary log '%s': %lu", path, GetLastError());
+        return false;
+    }
+
+    // this also extends the file to size
+    map_h = CreateFileMappingA(file_h, NULL, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32),
+                               (DWORD)(size & 0xFFFFFFFF), NULL);
+    if (map_h == NULL) {
+        LogMsg("Can't map binary log '%s': %lu", path, GetLastError());
+        CloseHandle(file_h);
+        file_h = INVALID_HANDLE_VALUE;
+        return false;
+    }
+
+    map_base = (char *)MapViewOfFile(map_h, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (map_base == NULL) {
+        LogMsg("Can't map binary log '%s': %lu", path, GetLastError());
+        CloseHandle(map_h);
+        CloseHandle(file_h);
+        file_h = INVALID_HANDLE_VALUE;
+        return false;
+    }
+#else
+    fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        LogMsg("Can't create binary log '%s': %s", path, strerror(errno));
+        return false;
+    }
+
+    void *m = MAP_FAILED;
+    if (ftruncate(fd, size) == 0)
+        m = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if (m == MAP_FAILED) {
+        LogMsg("Can't map binary log '%s': %s", path, strerror(errno));
+        close(fd);
+        fd = -1;
+        return false;
+    }
+
+    map_base = (char *)m;
+#endif
+
+    map_size = size;
+    auto hdr = reinterpret_cast<LogBinFileHdr *>(map_base);
+    memcpy(hdr->magic, kLogBinMagic, sizeof(hdr->magic));
+    hdr->size = size;
+    hdr->start_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::system_clock::now().time_since_epoch()).count();
+
+    t0_ns = NowNs();
+    used = sizeof(LogBinFileHdr);
+    dropped = 0;
+    log_bin::gen.fetch_add(1, std::memory_order_release);  // sites must write their definitions again
+    log_bin_active = true;
+
+    LogMsg("binary log '%s' opened, size: %d KB", path, (int)(size / 1024));
+    return true;
+}
+
+void LogBinClose() {
+    if (!log_bin_active.exchange(false))
+        return;
+
+    // wait for writers that are in the middle of a record
+    while (writers.load() > 0)
+        std::this_thread::yield();
+
+    uint64_t len = used.load();
+    if (len > map_size)
+        len = map_size;
+
+#if IBM == 1
+    UnmapViewOfFile(map_base);
+    CloseHandle(map_h);
+    LARGE_INTEGER li;
+    li.QuadPart = len;
+    if (SetFilePointerEx(file_h, li, NULL, FILE_BEGIN))
+        SetEndOfFile(file_h);
+    CloseHandle(file_h);
+    file_h = INVALID_HANDLE_VALUE;
+#else
+    munmap(map_base, map_size);
+    if (ftruncate(fd, len) != 0)
+        LogMsg("Can't truncate binary log: %s", strerror(errno));
+    close(fd);
+    fd = -1;
+#endif
+
+    map_base = nullptr;
+    LogMsg("binary log closed, %d KB used, %u records dropped", (int)(len / 1024), dropped.load());
+}
+
+unsigned LogBinDropped() {
+    return dropped.load(std::memory_order_relaxed);
+}
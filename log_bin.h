@@ -0,0 +1,195 @@
+//
+//    Copyright (C) 2026 Holger Teutsch
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 2.1 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+//    USA
+//
+
+#ifndef _LOG_BIN_H_
+#define _LOG_BIN_H_
+
+// Binary log with deferred formatting for high frequency tracing.
+//
+// LogBin(fmt, ...) records a format id, a timestamp and the raw argument bytes
+// into a memory mapped file. Formatting happens offline with log_bin_decode.cpp.
+//
+// Supported argument types: integers, float, double, pointers,
+// const char *, std::string and std::string_view (strings are truncated to kLogBinMaxStr).
+// Width or precision given as '*' and %n are not supported, the decoder prints them as is.
+//
+//  LogBinOpen("Output/my_plugin.blog", 16 * 1024 * 1024);
+//  ...
+//  LogBin("pos: %f %f, hdg: %d", lat, lon, hdg);
+//  ...
+//  LogBinClose();     // e.g. in XPluginStop after all threads are gone
+//
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// file layout, native byte order
+static constexpr char kLogBinMagic[8] = {'X', 'P', 'L', 'B', 'L', 'O', 'G', '1'};
+static constexpr uint32_t kLogBinDef = 0x80000000;   // id flag for definition records
+static constexpr size_t kLogBinMaxStr = 1024;
+
+struct LogBinFileHdr {
+    char magic[8];
+    uint64_t size;          // size of the mapping
+    uint64_t start_time;    // wall clock at open, ns since the epoch
+    uint64_t reserved;
+};
+
+// Records follow the file header, each 8 byte aligned.
+// len is written last, a 0 len terminates the log.
+// definition record: id | kLogBinDef, payload: uint32_t line, then 0-terminated types, file, fmt
+// event record: id, payload: packed arguments as described by types
+struct LogBinRecHdr {
+    uint32_t len;           // total length including header
+    uint32_t id;
+    uint64_t ts;            // ns since open
+};
+
+static_assert(sizeof(LogBinFileHdr) == 32 && sizeof(LogBinRecHdr) == 16);
+
+// functions
+extern bool LogBinOpen(const char *path, size_t size);
+extern void LogBinClose();
+extern unsigned LogBinDropped();    // # of records that did not fit
+
+extern std::atomic<bool> log_bin_active;
+
+struct LogBinSite {
+    const char *file;
+    int line;
+    const char *fmt;
+    std::atomic<uint32_t> id;       // 0 = not yet assigned
+    std::atomic<uint32_t> gen;      // file generation the definition was written to
+};
+
+namespace log_bin {
+
+extern std::atomic<uint32_t> gen;   // incremented for each opened file
+
+// type tags: i int32, I int64, u uint32, U uint64, d double, s string, p pointer
+template <typename T>
+constexpr char Tag() {
+    if constexpr (std::is_same_v<T, const char *> || std::is_same_v<T, char *> ||
+                  std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>)
+        return 's';
+    else if constexpr (std::is_pointer_v<T>)
+        return 'p';
+    else if constexpr (std::is_floating_point_v<T>)
+        return 'd';
+    else if constexpr (std::is_enum_v<T>)
+        return Tag<std::underlying_type_t<T>>();
+    else if constexpr (std::is_integral_v<T> && sizeof(T) <= 4)
+        return (std::is_signed_v<T> || sizeof(T) < 4) ? 'i' : 'u';   // promotion as in printf
+    else if constexpr (std::is_integral_v<T> && sizeof(T) == 8)
+        return std::is_signed_v<T> ? 'I' : 'U';
+    else
+        static_assert(sizeof(T) == 0, "unsupported argument type for LogBin");
+}
+
+template <typename... Args>
+struct Types {
+    static constexpr char str[] = {Tag<Args>()..., '\0'};
+};
+
+inline std::string_view StrArg(const char *s) { return s ? std::string_view(s) : std::string_view("(null)"); }
+inline std::string_view StrArg(std::string_view s) { return s; }
+
+template <typename T>
+inline size_t ArgSize(const T& a) {
+    constexpr char tag = Tag<std::decay_t<T>>();
+    if constexpr (tag == 's') {
+        size_t n = StrArg(a).size();
+        return 2 + (n < kLogBinMaxStr ? n : kLogBinMaxStr);
+    } else if constexpr (tag == 'i' || tag == 'u')
+        return 4;
+    else
+        return 8;
+}
+
+template <typename T>
+inline char *ArgPut(char *p, const T& a) {
+    constexpr char tag = Tag<std::decay_t<T>>();
+    if constexpr (tag == 's') {
+        std::string_view s = StrArg(a);
+        uint16_t n = s.size() < kLogBinMaxStr ? s.size() : kLogBinMaxStr;
+        memcpy(p, &n, 2);
+        memcpy(p + 2, s.data(), n);
+        return p + 2 + n;
+    } else {
+        if constexpr (tag == 'i') {
+            int32_t v = (int32_t)a;
+            memcpy(p, &v, 4);
+        } else if constexpr (tag == 'u') {
+            uint32_t v = (uint32_t)a;
+            memcpy(p, &v, 4);
+        } else if constexpr (tag == 'd') {
+            double v = a;
+            memcpy(p, &v, 8);
+        } else if constexpr (tag == 'p') {
+            uint64_t v = (uintptr_t)a;
+            memcpy(p, &v, 8);
+        } else {
+            memcpy(p, &a, 8);
+        }
+        return p + ArgSize(a);
+    }
+}
+
+extern void Define(LogBinSite& site, const char *types);
+
+// return ptr to payload of a reserved record or nullptr
+extern char *Begin(LogBinSite& site, size_t payload_len);
+extern void End(char *payload, size_t payload_len);
+
+template <typename... Args>
+inline void Write(LogBinSite& site, const Args&... args) {
+    if (site.gen.load(std::memory_order_acquire) != gen.load(std::memory_order_relaxed))
+        Define(site, Types<std::decay_t<Args>...>::str);
+
+    size_t len = (size_t{0} + ... + ArgSize(args));
+    char *p = Begin(site, len);
+    if (p == nullptr)
+        return;
+
+    char *pl = p;
+    ((p = ArgPut(p, args)), ...);
+    End(pl, len);
+}
+
+}  // namespace log_bin
+
+#ifdef __FILE_NAME__
+#define LOG_BIN_FILE __FILE_NAME__
+#else
+#define LOG_BIN_FILE __FILE__
+#endif
+
+#define LogBin(fmt, ...)                                                                  \
+    do {                                                                                  \
+        if (log_bin_active.load(std::memory_order_relaxed)) {                             \
+            static LogBinSite log_bin_site_{LOG_BIN_FILE, __LINE__, fmt, {0}, {0}};        \
+            log_bin::Write(log_bin_site_ __VA_OPT__(,) __VA_ARGS__);                      \
+        }                                                                                 \
+    } while (0)
+
+#endif
@@ -0,0 +1,278 @@
+//
+//    Decoder for binary logs written by LogBin
+//
+//    Copyright (C) 2026 Holger Teutsch
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 2.1 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+//    USA
+//
+
+// Standalone tool, build with e.g.
+//   c++ -std=c++20 -O2 -o log_bin_decode log_bin_decode.cpp
+//
+// usage: log_bin_decode file.blog > file.txt
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "log_bin.h"
+
+struct Def {
+    int line;
+    const char *types;
+    const char *file;
+    const char *fmt;
+};
+
+// 0 terminated string at s within [s, end), advances s past it, nullptr if not terminated
+static const char *NextStr(const char *&s, const char *end) {
+    const char *z = (const char *)memchr(s, '\0', end - s);
+    if (z == nullptr)
+        return nullptr;
+
+    const char *str = s;
+    s = z + 1;
+    return str;
+}
+
+// format one argument according to the conversion spec and the recorded type,
+// return # of bytes consumed from the payload or 0 on error
+static size_t FormatArg(std::string& out, std::string spec, char conv, char type,
+                        const char *p, const char *end) {
+    char buf[2048];
+
+    // drop length modifiers, we add our own
+    while (!spec.empty() && strchr("hljztLq", spec.back()))
+        spec.pop_back();
+
+    bool int_conv = strchr("diouxXc", conv) != nullptr;
+
+    switch (type) {
+        case 'i':
+        case 'u': {
+            if (end - p < 4)
+                return 0;
+            uint32_t v;
+            memcpy(&v, p, 4);
+            if (int_conv)
+                snprintf(buf, sizeof(buf), (spec + conv).c_str(), v);
+            else
+                snprintf(buf, sizeof(buf), type == 'i' ? "%d" : "%u", v);
+            out += buf;
+            return 4;
+        }
+
+        case 'I':
+        case 'U': {
+            if (end - p < 8)
+                return 0;
+            uint64_t v;
+            memcpy(&v, p, 8);
+            if (int_conv)
+                snprintf(buf, sizeof(buf), (spec + "ll" + conv).c_str(), (unsigned long long)v);
+            else
+                snprintf(buf, sizeof(buf), type == 'I' ? "%lld" : "%llu", (unsigned long long)v);
+            out += buf;
+            return 8;
+        }
+
+        case 'd': {
+            if (end - p < 8)
+                return 0;
+            double v;
+            memcpy(&v, p, 8);
+            if (strchr("eEfFgGaA", conv))
+                snprintf(buf, sizeof(buf), (spec + conv).c_str(), v);
+            else
+                snprintf(buf, sizeof(buf), "%g", v);
+            out += buf;
+            return 8;
+        }
+
+        case 'p': {
+            if (end - p < 8)
+                return 0;
+            uint64_t v;
+            memcpy(&v, p, 8);
+            snprintf(buf, sizeof(buf), "0x%llx", (unsigned long long)v);
+            out += buf;
+            return 8;
+        }
+
+        case 's': {
+            if (end - p < 2)
+                return 0;
+            uint16_t n;
+            memcpy(&n, p, 2);
+            if (end - p < 2 + n)
+                return 0;
+            std::string s(p + 2, n);
+            snprintf(buf, sizeof(buf), (spec + 's').c_str(), s.c_str());
+            out += buf;
+            return 2 + n;
+        }
+    }
+
+    return 0;
+}
+
+static std::string Format(const Def& def, const char *p, const char *end) {
+    std::string out;
+    const char *types = def.types;
+
+    for (const char *f = def.fmt; *f; f++) {
+        if (*f != '%') {
+            out += *f;
+            continue;
+        }
+
+        if (f[1] == '%') {
+            out += '%';
+            f++;
+            continue;
+        }
+
+        // collect the spec up to the conversion character, it goes into snprintf,
+        // so only flags, width, precision and length modifiers are accepted
+        std::string spec("%");
+        f++;
+        auto take = [&](const char *chars) {
+            size_t n = 0;
+            for (; *f && strchr(chars, *f); n++)
+                spec += *f++;
+            return n;
+        };
+
+        // width and precision beyond the 2 kB buffer of FormatArg are rejected as well
+        take("-+ #0");
+        bool valid = take("0123456789*") <= 3;
+        if (*f == '.') {
+            spec += *f++;
+            valid &= take("0123456789*") <= 3;
+        }
+        take("hljztLq");
+
+        if (*f == '\0' || !valid || !strchr("diouxXeEfFgGaAcspn", *f)) {
+            out += spec;    // not a conversion, print it as is
+            f--;
+            continue;
+        }
+
+        // '*' and %n are printed as is, their arguments are skipped
+        int n_skip = std::count(spec.begin(), spec.end(), '*');
+        if (n_skip > 0 || *f == 'n') {
+            out += spec + *f;
+            std::string dummy;
+            for (n_skip++; n_skip > 0 && *types; n_skip--) {     // + the one of the conversion
+                size_t n = FormatArg(dummy, "%", 'd', *types++, p, end);
+                if (n == 0)
+                    break;
+                p += n;
+            }
+            continue;
+        }
+
+        if (*types == '\0') {
+            out += "<missing arg>";
+            continue;
+        }
+
+        size_t n = FormatArg(out, spec, *f, *types++, p, end);
+        if (n == 0) {
+            out += "<truncated>";
+            break;
+        }
+        p += n;
+    }
+
+    return out;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s file\n", argv[0]);
+        return 2;
+    }
+
+    FILE *f = fopen(argv[1], "rb");
+    if (f == nullptr) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    std::vector<char> data;
+    char buf[64 * 1024];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+        data.insert(data.end(), buf, buf + n);
+    fclose(f);
+
+    if (data.size() < sizeof(LogBinFileHdr) || memcmp(data.data(), kLogBinMagic, sizeof(kLogBinMagic))) {
+        fprintf(stderr, "%s: not a binary log\n", argv[1]);
+        return 1;
+    }
+
+    const char *base = data.data();
+    const char *end = base + data.size();
+
+    // Definitions may show up after the first events of a site, so collect them first.
+    std::unordered_map<uint32_t, Def> defs;
+    for (int pass = 0; pass < 2; pass++) {
+        const char *p = base + sizeof(LogBinFileHdr);
+        while (end - p >= (ptrdiff_t)sizeof(LogBinRecHdr)) {
+            LogBinRecHdr rec;
+            memcpy(&rec, p, sizeof(rec));
+            if (rec.len < sizeof(LogBinRecHdr) || rec.len > end - p)
+                break;
+
+            const char *pl = p + sizeof(LogBinRecHdr);
+            const char *pl_end = p + rec.len;
+            p = pl_end;
+
+            if (rec.id & kLogBinDef) {
+                // skip truncated or corrupted ones, events of the site show up as unknown
+                if (pass == 0 && pl_end - pl >= 4) {
+                    Def def;
+                    memcpy(&def.line, pl, 4);
+                    const char *s = pl + 4;
+                    def.types = NextStr(s, pl_end);
+                    def.file = def.types ? NextStr(s, pl_end) : nullptr;
+                    def.fmt = def.file ? NextStr(s, pl_end) : nullptr;
+                    if (def.fmt)
+                        defs[rec.id & ~kLogBinDef] = def;
+                }
+                continue;
+            }
+
+            if (pass == 0)
+                continue;
+
+            auto it = defs.find(rec.id);
+            if (it == defs.end()) {
+                printf("%14.6f <unknown id %u>\n", rec.ts * 1.0E-9, rec.id);
+                continue;
+            }
+
+            const Def& def = it->second;
+            printf("%14.6f %s:%d: %s\n", rec.ts * 1.0E-9, def.file, def.line, Format(def, pl, pl_end).c_str());
+        }
+    }
+
+    return 0;
+}
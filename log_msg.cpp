@@ -17,9 +17,15 @@
 //    USA
 //
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdarg>
 #include <cstring>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <initializer_list>
+#include <thread>
 
 #include "log_msg.h"
 
@@ -33,26 +39,354 @@ void XPLMDebugString(const char *str) {
 
 // This function can be called from anywhere anytime (e.g. from destructors of static objects).
 // Avoid using static objects here that might already be gone when LogMsg is still be called.
+// Therefore everything below is plain or atomic static data with trivial destructors.
 
-void LogMsgImpl(const char *fmt, ...) {
-    char line[1024];
+static constexpr int kLineSize = 1024;
+
+std::atomic<int> log_level{LOG_LEVEL_INFO};
+
+// Ring buffer for async mode, multiple producers, single consumer.
+// This follows D. Vyukov's bounded queue but encodes the state of a slot at position pos as
+//   seq == 2 * (pos / kLogSlots)       slot is free
+//   seq == 2 * (pos / kLogSlots) + 1   slot is filled
+// so zero initialized static storage is a valid empty ring.
+static constexpr int kLogSlots = 256;  // must be a power of 2
+static_assert((kLogSlots & (kLogSlots - 1)) == 0);
+
+struct LogSlot {
+    std::atomic<uint64_t> seq;
+    int len;
+    char line[kLineSize];
+};
+
+static LogSlot log_ring[kLogSlots];
+static std::atomic<uint64_t> log_head;   // next position to fill
+static uint64_t log_tail;                // next position to drain, protected by log_drain_lock
+static unsigned log_dropped_reported;    // protected by log_drain_lock
+
+static std::atomic<bool> log_async;
+static std::atomic<LogOverflow> log_overflow;
+static std::atomic<unsigned> log_dropped;
+static std::atomic_flag log_drain_lock;
+static thread_local bool log_is_drainer;
+
+// # of producers that may write into the ring, see LogMsgAsyncDisable()
+static std::atomic<int> log_producers;
+
+// Enter the async path, false if not in async mode. Leave with AsyncLeave().
+static inline bool AsyncEnter() {
+    if (!log_async.load(std::memory_order_relaxed))
+        return false;
+
+    log_producers.fetch_add(1, std::memory_order_seq_cst);
+    if (log_async.load(std::memory_order_seq_cst))
+        return true;
+
+    log_producers.fetch_sub(1, std::memory_order_release);
+    return false;
+}
+
+static inline void AsyncLeave() {
+    log_producers.fetch_sub(1, std::memory_order_release);
+}
+
+// Get n consecutive free slots, return the first one or nullptr if the ring is full.
+// Slots are drained in order, so if the last one is free all of them are.
+static LogSlot* SlotAcquire(int n) {
+    uint64_t pos = log_head.load(std::memory_order_relaxed);
+    for (;;) {
+        uint64_t last = pos + n - 1;
+        uint64_t seq = log_ring[last & (kLogSlots - 1)].seq.load(std::memory_order_acquire);
+        uint64_t turn = 2 * (last / kLogSlots);
+        if (seq == turn) {
+            if (log_head.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed))
+                return &log_ring[pos & (kLogSlots - 1)];
+        } else if (seq < turn) {
+            return nullptr;  // still occupied from the previous round
+        } else {
+            pos = log_head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+// get n consecutive slots according to the overflow policy
+static LogSlot* SlotGet(int n = 1) {
+    for (;;) {
+        LogSlot* slot = SlotAcquire(n);
+        if (slot)
+            return slot;
+
+        if (log_overflow.load(std::memory_order_relaxed) == LogOverflow::kDrop) {
+            log_dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        // the drainer can't wait for itself
+        if (log_is_drainer)
+            LogMsgDrain();
+        else
+            std::this_thread::yield();
+    }
+}
+
+static inline LogSlot* SlotNext(LogSlot* slot) {
+    return (slot == &log_ring[kLogSlots - 1]) ? log_ring : slot + 1;
+}
+
+static inline void SlotPublish(LogSlot* slot) {
+    slot->seq.fetch_add(1, std::memory_order_release);
+}
+
+// format prefix + message + "\n" into line, return length
+static int FormatLine(char* line, int size, const char* fmt, va_list ap) {
+    int n = strlen(log_msg_prefix);
+    if (n > size / 2)
+        n = size / 2;
+    memcpy(line, log_msg_prefix, n);
+
+    int m = vsnprintf(line + n, size - n - 1, fmt, ap);
+    if (m < 0)
+        m = 0;
+
+    int len = (n + m < size - 2) ? n + m : size - 2;
+    line[len++] = '\n';
+    line[len] = '\0';
+    return len;
+}
+
+// Write the concatenation of strings of arbitrary length. In async mode it's split across
+// consecutive slots so it's not interleaved with messages of other threads. It's truncated
+// to a quarter of the ring, then the last chunk ends with "...\n".
+static void LogPut(std::initializer_list<const char*> strs) {
+    if (!AsyncEnter()) {
+        for (const char* str : strs)
+            XPLMDebugString(str);
+        return;
+    }
+
+    static constexpr int kChunk = kLineSize - 1;
+    static constexpr int kMaxSlots = kLogSlots / 4;
+    static constexpr char kTrunc[] = "...\n";
+
+    int total = 0;
+    for (const char* str : strs)
+        total += strlen(str);
 
+    bool truncated = (total + kChunk - 1) / kChunk > kMaxSlots;
+    int limit = truncated ? kMaxSlots * kChunk - (int)strlen(kTrunc) : total;
+    int n_slots = std::min((total + kChunk - 1) / kChunk, kMaxSlots);
+    LogSlot* slot = (n_slots > 0) ? SlotGet(n_slots) : nullptr;
+    if (slot) {
+        int len = 0;
+        auto put = [&](char c) {
+            slot->line[len++] = c;
+            if (len == kChunk) {
+                slot->line[len] = '\0';
+                slot->len = len;
+                len = 0;
+                n_slots--;
+                LogSlot* next = SlotNext(slot);
+                SlotPublish(slot);
+                slot = next;
+            }
+        };
+
+        int n = 0;
+        for (const char* str : strs)
+            for (; *str && n < limit; str++, n++)
+                put(*str);
+
+        if (truncated)
+            for (const char* t = kTrunc; *t; t++)
+                put(*t);
+
+        if (n_slots > 0) {      // the last partial chunk
+            slot->line[len] = '\0';
+            slot->len = len;
+            SlotPublish(slot);
+        }
+    }
+
+    AsyncLeave();
+}
+
+void LogMsgImpl(const char *fmt, ...) {
     va_list ap;
     va_start(ap, fmt);
-    const std::string fmt_combined = std::string(log_msg_prefix) + fmt + "\n";
-    vsnprintf(line, sizeof(line) - 3, fmt_combined.c_str(), ap);
-    XPLMDebugString(line);
+
+    if (AsyncEnter()) {
+        LogSlot* slot = SlotGet();
+        if (slot) {
+            slot->len = FormatLine(slot->line, kLineSize, fmt, ap);
+            SlotPublish(slot);
+        }
+        AsyncLeave();
+    } else {
+        char line[kLineSize];
+        FormatLine(line, sizeof(line), fmt, ap);
+        XPLMDebugString(line);
+    }
+
     va_end(ap);
 }
 
 void LogMsgRawImpl(const char *file, int line_no, const char *str) {
-    char line[1024];
+    char line[kLineSize];
     snprintf(line, sizeof(line) - 3, "%s%s:%d: *raw*\n", log_msg_prefix, file, line_no);
-    XPLMDebugString(line);
-    XPLMDebugString(str);
-    XPLMDebugString("\n");
+    LogPut({line, str, "\n"});
 }
 
 void LogMsgRawImpl(const char *file, int line_no, const std::string& str) {
     LogMsgRawImpl(file, line_no, str.c_str());
 }
+
+void LogMsgAsyncEnable(LogOverflow overflow) {
+    log_overflow.store(overflow, std::memory_order_relaxed);
+    log_is_drainer = true;  // most likely we are on the main thread
+    log_async.store(true, std::memory_order_release);
+}
+
+void LogMsgAsyncDisable() {
+    LogMsgFlushSuppressed(true);
+    log_async.store(false, std::memory_order_seq_cst);
+
+    // Producers that have seen async mode may still write into the ring, wait for them.
+    // They may wait for room themselves (kBlock), so keep draining.
+    while (log_producers.load(std::memory_order_seq_cst) > 0) {
+        LogMsgDrain();
+        std::this_thread::yield();
+    }
+
+    LogMsgDrain();
+}
+
+int LogMsgDrain() {
+    if (log_drain_lock.test_and_set(std::memory_order_acquire))
+        return 0;  // someone else is draining
+
+    log_is_drainer = true;
+
+    // collect lines into batches to reduce the number of XPLMDebugString calls
+    char batch[8 * kLineSize];
+    int blen = 0;
+    int n = 0;
+
+    unsigned dropped = log_dropped.load(std::memory_order_relaxed);
+    if (dropped != log_dropped_reported) {
+        blen = snprintf(batch, sizeof(batch), "%s%u log messages dropped\n", log_msg_prefix,
+                        dropped - log_dropped_reported);
+        log_dropped_reported = dropped;
+    }
+
+    uint64_t pos = log_tail;
+    for (;;) {
+        LogSlot& slot = log_ring[pos & (kLogSlots - 1)];
+        uint64_t turn = 2 * (pos / kLogSlots);
+        if (slot.seq.load(std::memory_order_acquire) != turn + 1)
+            break;  // empty or still being written
+
+        if (blen + slot.len >= (int)sizeof(batch)) {
+            XPLMDebugString(batch);
+            blen = 0;
+        }
+
+        memcpy(batch + blen, slot.line, slot.len);
+        blen += slot.len;
+        batch[blen] = '\0';
+        slot.seq.store(turn + 2, std::memory_order_release);
+        pos++;
+        n++;
+    }
+
+    log_tail = pos;
+    if (blen > 0)
+        XPLMDebugString(batch);
+
+    log_drain_lock.clear(std::memory_order_release);
+
+    // goes into the ring and is written by the next drain
+    LogMsgFlushSuppressed();
+    return n;
+}
+
+unsigned LogMsgDropped() {
+    return log_dropped.load(std::memory_order_relaxed);
+}
+
+static std::atomic<LogSite*> log_sites;   // list of all used sites
+static std::atomic_flag log_flushing;
+
+static int64_t NowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void LogSuppressed(const char *where, bool dedup, unsigned suppressed) {
+    if (dedup)
+        LogMsgImpl("%slast message repeated %u times", where, suppressed);
+    else
+        LogMsgImpl("%s%u messages suppressed", where, suppressed);
+}
+
+bool LogSiteCheck(LogSite& site, const char *where, float interval, uint64_t hash, bool dedup) {
+    int64_t now = NowMs();
+
+    while (site.lock.test_and_set(std::memory_order_acquire))
+        std::this_thread::yield();
+
+    bool emit = !site.used || now - site.last_ms >= (int64_t)(interval * 1000.0f) ||
+                (dedup && hash != site.hash);
+
+    unsigned suppressed = 0;
+    if (emit) {
+        if (!site.used) {
+            site.where = where;
+            site.interval = interval;
+            site.dedup = dedup;
+            site.next = log_sites.load(std::memory_order_relaxed);
+            while (!log_sites.compare_exchange_weak(site.next, &site, std::memory_order_release,
+                                                    std::memory_order_relaxed))
+                ;
+        }
+
+        suppressed = site.suppressed;
+        site.suppressed = 0;
+        site.used = true;
+        site.last_ms = now;
+        site.hash = hash;
+    } else {
+        site.suppressed++;
+    }
+
+    site.lock.clear(std::memory_order_release);
+
+    if (suppressed > 0)
+        LogSuppressed(where, dedup, suppressed);
+
+    return emit;
+}
+
+void LogMsgFlushSuppressed(bool all) {
+    // the messages below may end up in LogMsgDrain() that calls us again
+    if (log_flushing.test_and_set(std::memory_order_acquire))
+        return;
+
+    int64_t now = NowMs();
+    for (LogSite* site = log_sites.load(std::memory_order_acquire); site; site = site->next) {
+        while (site->lock.test_and_set(std::memory_order_acquire))
+            std::this_thread::yield();
+
+        unsigned suppressed = 0;
+        if (site->suppressed > 0 && (all || now - site->last_ms >= (int64_t)(site->interval * 1000.0f))) {
+            suppressed = site->suppressed;
+            site->suppressed = 0;
+        }
+
+        site->lock.clear(std::memory_order_release);
+
+        if (suppressed > 0)
+            LogSuppressed(site->where, site->dedup, suppressed);
+    }
+
+    log_flushing.clear(std::memory_order_release);
+}
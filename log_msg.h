@@ -20,7 +20,11 @@
 #ifndef _LOG_MSG_H_
 #define _LOG_MSG_H_
 
+#include <atomic>
+#include <cstdint>
+#include <cstring>
 #include <string>
+#include <type_traits>
 
 // define this in your plugin, e.g.
 // const char* log_msg_prefix = "opensam: ";
@@ -32,13 +36,144 @@ extern void LogMsgImpl(const char *, ...) __attribute__ ((format (printf, 1, 2))
 extern void LogMsgRawImpl(const char *, int, const char *);
 extern void LogMsgRawImpl(const char *, int, const std::string& str);
 
+// Asynchronous mode
+// In async mode LogMsg just formats into a bounded lock free ring buffer and returns.
+// Messages are handed to XPLMDebugString in batches by LogMsgDrain() that must be called
+// periodically, e.g. from a flight loop callback on the main thread.
+// Once in async mode LogMsg can safely be called from any thread.
+enum class LogOverflow {
+    kDrop,      // drop the message and count it, the count is reported by the next drain
+    kBlock      // wait until the drainer has made room
+};
+
+extern void LogMsgAsyncEnable(LogOverflow overflow = LogOverflow::kDrop);
+extern void LogMsgAsyncDisable();   // drains pending messages and switches back to sync mode
+extern int LogMsgDrain();           // returns # of messages written
+extern unsigned LogMsgDropped();    // total # of dropped messages
+
+// Per call site state of rate limited or deduplicating messages.
+// Lives in static storage, so a suppressed call neither formats nor allocates.
+struct LogSite {
+    std::atomic_flag lock;
+    bool used;              // a message was emitted before
+    int64_t last_ms;        // time of the last emitted message
+    uint64_t hash;          // hash of the arguments of the last emitted message
+    unsigned suppressed;
+
+    // set on first use, then the site is linked into the list of all sites
+    const char *where;
+    float interval;
+    bool dedup;
+    LogSite *next;
+};
+
+// Return true if the message is to be emitted. Suppressed messages are reported
+// with the next emitted message of the site or by LogMsgFlushSuppressed().
+extern bool LogSiteCheck(LogSite& site, const char *where, float interval, uint64_t hash, bool dedup);
+
+// Report suppressed messages of all sites whose interval has expired, or of all sites
+// if all is true, e.g. at shutdown. LogMsgDrain() and LogMsgAsyncDisable() call it,
+// in sync mode call it periodically yourself.
+extern void LogMsgFlushSuppressed(bool all = false);
+
+namespace log_msg {
+
+// FNV-1a over the argument values, strings by content
+inline uint64_t HashBytes(uint64_t h, const void *p, size_t len) {
+    auto c = static_cast<const unsigned char *>(p);
+    for (size_t i = 0; i < len; i++)
+        h = (h ^ c[i]) * 0x100000001b3ULL;
+    return h;
+}
+
+inline uint64_t HashArg(uint64_t h, const char *s) { return s ? HashBytes(h, s, strlen(s)) : h; }
+inline uint64_t HashArg(uint64_t h, const std::string& s) { return HashBytes(h, s.data(), s.size()); }
+
+template <typename T>
+inline uint64_t HashArg(uint64_t h, const T& v) {
+    static_assert(std::is_arithmetic_v<T> || std::is_pointer_v<T> || std::is_enum_v<T>);
+    return HashBytes(h, &v, sizeof(v));
+}
+
+template <typename... Args>
+inline uint64_t HashArgs(const Args&... args) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    ((h = HashArg(h, args)), ...);
+    return h;
+}
+
+}  // namespace log_msg
+
+// Log levels
+#define LOG_LEVEL_TRACE 0
+#define LOG_LEVEL_DEBUG 1
+#define LOG_LEVEL_INFO  2
+#define LOG_LEVEL_WARN  3
+#define LOG_LEVEL_ERROR 4
+
+// Leveled call sites below this level are removed at compile time,
+// e.g. -DLOG_MIN_LEVEL=LOG_LEVEL_INFO for release builds.
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL LOG_LEVEL_TRACE
+#endif
+
+// Runtime minimum level for leveled call sites, defaults to LOG_LEVEL_INFO.
+// Plain LogMsg is not subject to levels.
+extern std::atomic<int> log_level;
+
+#define LOG_STR_(x) #x
+#define LOG_STR(x) LOG_STR_(x)
+
+// "file:line: " as a string literal
+#ifdef __FILE_NAME__
+#define LOG_SITE __FILE_NAME__ ":" LOG_STR(__LINE__) ": "
+#else
+#define LOG_SITE __FILE__ ":" LOG_STR(__LINE__) ": "
+#endif
+
 // This macro is used to log messages with a file name and line number.
+#define LogMsg(fmt, ...) LogMsgImpl(LOG_SITE fmt __VA_OPT__(,) __VA_ARGS__)
+
 #ifdef __FILE_NAME__
-#define LogMsg(fmt, ...) LogMsgImpl(__FILE_NAME__  ":%d: " fmt, __LINE__ __VA_OPT__(,) __VA_ARGS__)
 #define LogMsgRaw(str) LogMsgRawImpl(__FILE_NAME__, __LINE__, str)
 #else
-#define LogMsg(fmt, ...) LogMsgImpl(__FILE__  ":%d: " fmt, __LINE__ __VA_OPT__(,) __VA_ARGS__)
 #define LogMsgRaw(str) LogMsgRawImpl(__FILE__, __LINE__, str)
 #endif
 
+// At most one message per interval (seconds) from this call site.
+#define LogMsgRateLimited(interval, fmt, ...)                                   \
+    do {                                                                        \
+        static LogSite log_site_;                                               \
+        if (LogSiteCheck(log_site_, LOG_SITE, interval, 0, false))              \
+            LogMsgImpl(LOG_SITE fmt __VA_OPT__(,) __VA_ARGS__);                 \
+    } while (0)
+
+// Repetitions of the same message (same argument values) from this call site
+// are suppressed for interval seconds.
+// The arguments are bound to the parameters of a lambda, so each is evaluated once.
+#define LogMsgDedup(interval, fmt, ...)                                         \
+    do {                                                                        \
+        static LogSite log_site_;                                               \
+        [&](const auto&... log_args_) {                                         \
+            if (LogSiteCheck(log_site_, LOG_SITE, interval,                     \
+                             log_msg::HashArgs(log_args_...), true))            \
+                LogMsgImpl(LOG_SITE fmt, log_args_...);                         \
+        }(__VA_ARGS__);                                                         \
+    } while (0)
+
+// Leveled variants. Arguments are only evaluated if the level is enabled.
+#define LogLevelMsg_(level, tag, fmt, ...)                                      \
+    do {                                                                        \
+        if constexpr ((level) >= LOG_MIN_LEVEL) {                               \
+            if ((level) >= log_level.load(std::memory_order_relaxed))           \
+                LogMsgImpl(LOG_SITE tag fmt __VA_OPT__(,) __VA_ARGS__);         \
+        }                                                                       \
+    } while (0)
+
+#define LogTrace(fmt, ...) LogLevelMsg_(LOG_LEVEL_TRACE, "TRACE: ", fmt __VA_OPT__(,) __VA_ARGS__)
+#define LogDebug(fmt, ...) LogLevelMsg_(LOG_LEVEL_DEBUG, "DEBUG: ", fmt __VA_OPT__(,) __VA_ARGS__)
+#define LogInfo(fmt, ...)  LogLevelMsg_(LOG_LEVEL_INFO, "", fmt __VA_OPT__(,) __VA_ARGS__)
+#define LogWarn(fmt, ...)  LogLevelMsg_(LOG_LEVEL_WARN, "WARN: ", fmt __VA_OPT__(,) __VA_ARGS__)
+#define LogError(fmt, ...) LogLevelMsg_(LOG_LEVEL_ERROR, "ERROR: ", fmt __VA_OPT__(,) __VA_ARGS__)
+
 #endif
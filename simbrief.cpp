@@ -21,199 +21,693 @@
 
 #include "simbrief.h"
 
-#include <cassert>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
 #include <ctime>
 #include <cstring>
+#include <iterator>
+#include <map>
 
 #ifndef XPLM210
 #error "need at least XPLM210"
 #endif
 
-#include "XPLMDataAccess.h"
+#include "XPLMProcessing.h"
 
+#include "dataref.h"
+#include "http_get.h"
 #include "log_msg.h"
+#include "trace.h"
 
-static bool drefs_loaded, sbh_unavail;
-
-#define DEF_OFP_DR(f) static XPLMDataRef f ## _dr;
-#define DEF_CDM_DR(f) static XPLMDataRef cdm_ ## f ## _dr;
-DEF_OFP_DR(icao_airline);
-DEF_OFP_DR(flight_number);
-DEF_OFP_DR(aircraft_icao);
-DEF_OFP_DR(destination);
-DEF_OFP_DR(pax_count);
-DEF_OFP_DR(freight);
-DEF_OFP_DR(est_out);
-DEF_OFP_DR(est_off);
-DEF_OFP_DR(est_on);
-DEF_OFP_DR(est_in);
-DEF_OFP_DR(dx_rmk);
-
-DEF_CDM_DR(tobt);
-DEF_CDM_DR(tsat);
-DEF_CDM_DR(ctot);
-DEF_CDM_DR(runway);
-DEF_CDM_DR(sid);
-
-#undef DEF_OFP_DREF_DR
-#undef DEF_CDM_DREF_DR
-
-static XPLMDataRef seqno_dr, cdm_seqno_dr, stale_dr;
-static int sbh_ofp_seqno, sbh_cdm_seqno, my_seqno;
-
-// fetch byte data into a string
-static void FetchDref(std::string& str, XPLMDataRef dr) {
-    str.clear();
-    if (dr == nullptr)
-        return;
+static bool drefs_loaded, sbh_unavail, have_seqnos;
 
-    auto n = XPLMGetDatab(dr, nullptr, 0, 0);
-    if (n == 0)
-        return;
+struct SbhState {
+    int seqno;
+    int cdm_seqno;
+    int stale;
+};
 
-    str.resize(n + 1);  // ensure we always have a trailing 0
-    auto n1 = XPLMGetDatab(dr, (void*)str.data(), 0, n);
-    assert(n == n1);
-    // in case a 0-terminated string was returned make it a compatible std::string
-    str.resize(strlen(str.c_str()));
-}
+static SbhState sbh;
+static DrefRegistry<SbhState> sbh_drefs, seqno_drefs;    // seqnos are missing in older hubs
+static DrefRegistry<Ofp> ofp_drefs, cdm_drefs;     // bound in the order of the change mask bits
+static int sbh_ofp_seqno, sbh_cdm_seqno;
+static std::atomic<int> my_seqno;       // FetchDirect may run in a background thread
 
-#define FIND_OFP_DREF(f) f##_dr = XPLMFindDataRef("sbh/" #f)
-#define FIND_CDM_DREF(f)  cdm_ ## f ## _dr = XPLMFindDataRef("sbh/cdm/" #f)
+#define BIND_OFP_DREF(f) ofp_drefs.Bind<&Ofp::f>("sbh/" #f)
+#define BIND_CDM_DREF(f) cdm_drefs.Bind<&Ofp::cdm_ ## f>("sbh/cdm/" #f)
+#define LOG_FIELD(f, bit) if (mask & Ofp::bit) LogMsg(" " #f ": '%s'", ofp.f.c_str())
 
-#define GET_OFP_DREF(f) FetchDref(ofp->f, f ## _dr)
-#define GET_CDM_DREF(f) FetchDref(ofp->cdm_ ## f, cdm_ ## f ## _dr)
-#define LOG_FIELD(f) LogMsg(" " #f ": '%s'", ofp->f.c_str())
-
-std::unique_ptr<Ofp> Ofp::LoadIfNewer([[maybe_unused]] int cur_seqno) {
+static bool FindDrefs() {
     if (sbh_unavail)
-        return nullptr;
+        return false;
 
     if (!drefs_loaded) {
-        stale_dr = XPLMFindDataRef("sbh/stale");
-        if (stale_dr == nullptr) {
+        sbh_drefs.Bind<&SbhState::stale>("sbh/stale");
+        if (!sbh_drefs.Resolve()) {
             sbh_unavail = true;
             LogMsg("simbrief_hub plugin is not loaded, bye!");
-            return nullptr;
+            return false;
         }
 
-        seqno_dr = XPLMFindDataRef("sbh/seqno");
-
-        FIND_OFP_DREF(icao_airline);
-        FIND_OFP_DREF(flight_number);
-        FIND_OFP_DREF(aircraft_icao);
-        FIND_OFP_DREF(destination);
-        FIND_OFP_DREF(pax_count);
-        FIND_OFP_DREF(est_out);
-        FIND_OFP_DREF(est_off);
-        FIND_OFP_DREF(est_on);
-        FIND_OFP_DREF(est_in);
-        FIND_OFP_DREF(freight);
-        FIND_OFP_DREF(dx_rmk);
-
-        FIND_CDM_DREF(seqno);
-        FIND_CDM_DREF(tobt);
-        FIND_CDM_DREF(tsat);
-        FIND_CDM_DREF(ctot);
-        FIND_CDM_DREF(runway);
-        FIND_CDM_DREF(sid);
+        seqno_drefs.Bind<&SbhState::seqno>("sbh/seqno");
+        seqno_drefs.Bind<&SbhState::cdm_seqno>("sbh/cdm/seqno");
+        have_seqnos = seqno_drefs.Resolve();
+        if (!have_seqnos)
+            LogMsg("simbrief_hub without seqnos, comparing all fields");
+
+        BIND_OFP_DREF(icao_airline);
+        BIND_OFP_DREF(flight_number);
+        BIND_OFP_DREF(aircraft_icao);
+        BIND_OFP_DREF(destination);
+        BIND_OFP_DREF(pax_count);
+        BIND_OFP_DREF(freight);
+        BIND_OFP_DREF(est_out);
+        BIND_OFP_DREF(est_off);
+        BIND_OFP_DREF(est_on);
+        BIND_OFP_DREF(est_in);
+        BIND_OFP_DREF(dx_rmk);
+        ofp_drefs.Resolve();
+
+        BIND_CDM_DREF(tobt);
+        BIND_CDM_DREF(tsat);
+        BIND_CDM_DREF(ctot);
+        BIND_CDM_DREF(runway);
+        BIND_CDM_DREF(sid);
+        cdm_drefs.Resolve();
         drefs_loaded = true;
     }
 
-    int ofp_seqno = XPLMGetDatai(seqno_dr);
-    int cdm_seqno = XPLMGetDatai(cdm_seqno_dr);
+    return true;
+}
+
+static unsigned ReadOfpGroup(Ofp& ofp) {
+    return ofp_drefs.Read(ofp);
+}
+
+static unsigned ReadCdmGroup(Ofp& ofp) {
+    static_assert(Ofp::kCdmTobt == 1 << 11);
+    return cdm_drefs.Read(ofp) << 11;
+}
+
+static void LogFields(const Ofp& ofp, unsigned mask) {
+    LOG_FIELD(icao_airline, kIcaoAirline);
+    LOG_FIELD(flight_number, kFlightNumber);
+    LOG_FIELD(aircraft_icao, kAircraftIcao);
+    LOG_FIELD(destination, kDestination);
+    LOG_FIELD(pax_count, kPaxCount);
+    LOG_FIELD(freight, kFreight);
+    LOG_FIELD(est_out, kEstOut);
+    LOG_FIELD(est_off, kEstOff);
+    LOG_FIELD(est_on, kEstOn);
+    LOG_FIELD(est_in, kEstIn);
+    LOG_FIELD(dx_rmk, kDxRmk);
+    LOG_FIELD(cdm_tobt, kCdmTobt);
+    LOG_FIELD(cdm_tsat, kCdmTsat);
+    LOG_FIELD(cdm_ctot, kCdmCtot);
+    LOG_FIELD(cdm_runway, kCdmRunway);
+    LOG_FIELD(cdm_sid, kCdmSid);
+}
+
+static void CheckStale() {
+    if (sbh.stale)
+        LogMsgDedup(300, "simbrief_hub data may be stale");
+}
+
+std::unique_ptr<Ofp> Ofp::LoadIfNewer([[maybe_unused]] int cur_seqno) {
+    TraceSpan("Ofp::LoadIfNewer");
+    if (!FindDrefs())
+        return nullptr;
+
+    sbh_drefs.Read(sbh);
+    if (!have_seqnos) {
+        static Ofp hub_ofp;     // the last version read
+        unsigned mask = ReadOfpGroup(hub_ofp) | ReadCdmGroup(hub_ofp);
+        if (mask == 0)
+            return nullptr;
+
+        CheckStale();
+        auto ofp = std::make_unique<Ofp>(hub_ofp);
+        ofp->seqno = ++my_seqno;
+        LogMsg("From simbrief_hub: Seqno: %d", ofp->seqno);
+        LogFields(*ofp, kOfpGroup | kCdmGroup);
+        return ofp;
+    }
+
+    seqno_drefs.Read(sbh);
+    int ofp_seqno = sbh.seqno;
+    int cdm_seqno = sbh.cdm_seqno;
     if (ofp_seqno == sbh_ofp_seqno && cdm_seqno == sbh_cdm_seqno)
         return nullptr;
 
     sbh_ofp_seqno = ofp_seqno;
     sbh_cdm_seqno = cdm_seqno;
-    my_seqno++;
 
-    int stale = XPLMGetDatai(stale_dr);
-    if (stale)
-        LogMsg("simbrief_hub data may be stale");
+    CheckStale();
 
     auto ofp = std::make_unique<Ofp>();
 
-    ofp->seqno = my_seqno;
-    GET_OFP_DREF(icao_airline);
-    GET_OFP_DREF(flight_number);
-    GET_OFP_DREF(aircraft_icao);
-    GET_OFP_DREF(destination);
-    GET_OFP_DREF(pax_count);
-    GET_OFP_DREF(freight);
-    GET_OFP_DREF(est_out);
-    GET_OFP_DREF(est_off);
-    GET_OFP_DREF(est_on);
-    GET_OFP_DREF(est_in);
-    GET_OFP_DREF(dx_rmk);
-    GET_CDM_DREF(tobt);
-    GET_CDM_DREF(tsat);
-    GET_CDM_DREF(ctot);
-    GET_CDM_DREF(runway);
-    GET_CDM_DREF(sid);
-
+    ofp->seqno = ++my_seqno;
+    ofp->src_seqno = ofp_seqno;
+    ofp->src_cdm_seqno = cdm_seqno;
+    ReadOfpGroup(*ofp);
+    ReadCdmGroup(*ofp);
     LogMsg("From simbrief_hub: Seqno: %d, Cdm: %d", ofp_seqno, cdm_seqno);
-    LOG_FIELD(icao_airline);
-    LOG_FIELD(flight_number);
-    LOG_FIELD(aircraft_icao);
-    LOG_FIELD(destination);
-    LOG_FIELD(pax_count);
-    LOG_FIELD(freight);
-    LOG_FIELD(est_out);
-    LOG_FIELD(est_off);
-    LOG_FIELD(est_on);
-    LOG_FIELD(est_in);
-    LOG_FIELD(dx_rmk);
-    LOG_FIELD(cdm_tobt);
-    LOG_FIELD(cdm_tsat);
-    LOG_FIELD(cdm_ctot);
-    LOG_FIELD(cdm_runway);
-    LOG_FIELD(cdm_sid);
+    LogFields(*ofp, kOfpGroup | kCdmGroup);
+    return ofp;
+}
+
+unsigned Ofp::UpdateIfNewer() {
+    TraceSpan("Ofp::UpdateIfNewer");
+    if (!FindDrefs())
+        return 0;
+
+    sbh_drefs.Read(sbh);
+    if (!have_seqnos) {
+        unsigned mask = ReadOfpGroup(*this) | ReadCdmGroup(*this);
+        if (mask) {
+            CheckStale();
+            seqno = ++my_seqno;
+            LogMsg("From simbrief_hub: Seqno: %d", seqno);
+            LogFields(*this, mask);
+        }
+
+        return mask;
+    }
+
+    seqno_drefs.Read(sbh);
+    int ofp_seqno = sbh.seqno;
+    int cdm_seqno = sbh.cdm_seqno;
+    if (ofp_seqno == src_seqno && cdm_seqno == src_cdm_seqno)
+        return 0;
+
+    CheckStale();
+
+    unsigned mask = 0;
+    if (ofp_seqno != src_seqno)
+        mask |= ReadOfpGroup(*this);
+    if (cdm_seqno != src_cdm_seqno)
+        mask |= ReadCdmGroup(*this);
+
+    src_seqno = ofp_seqno;
+    src_cdm_seqno = cdm_seqno;
+
+    if (mask) {
+        seqno = ++my_seqno;
+        LogMsg("From simbrief_hub: Seqno: %d, Cdm: %d", ofp_seqno, cdm_seqno);
+        LogFields(*this, mask);
+    }
+
+    return mask;
+}
+
+// all fields in the order of the change mask bits
+static std::string Ofp::* const ofp_fields[] = {
+    &Ofp::icao_airline, &Ofp::flight_number, &Ofp::aircraft_icao, &Ofp::destination,
+    &Ofp::pax_count, &Ofp::freight, &Ofp::est_out, &Ofp::est_off, &Ofp::est_on, &Ofp::est_in,
+    &Ofp::dx_rmk,
+    &Ofp::cdm_tobt, &Ofp::cdm_tsat, &Ofp::cdm_ctot, &Ofp::cdm_runway, &Ofp::cdm_sid
+};
+
+unsigned Ofp::Diff(const Ofp& other) const {
+    unsigned mask = 0;
+    for (unsigned i = 0; i < std::size(ofp_fields); i++)
+        if (this->*ofp_fields[i] != other.*ofp_fields[i])
+            mask |= 1 << i;
+    return mask;
+}
+
+bool Ofp::HubAvailable() {
+    return !sbh_unavail;
+}
+
+// elements of a SimBrief XML OFP, bit i of OfpXmlParser::found_ = entry i
+static const struct {
+    const char *path;
+    std::string Ofp::*field;
+} xml_fields[] = {
+    {"OFP/general/icao_airline", &Ofp::icao_airline},
+    {"OFP/general/flight_number", &Ofp::flight_number},
+    {"OFP/general/dx_rmk", &Ofp::dx_rmk},
+    {"OFP/aircraft/icaocode", &Ofp::aircraft_icao},
+    {"OFP/destination/icao_code", &Ofp::destination},
+    {"OFP/weights/pax_count", &Ofp::pax_count},
+    {"OFP/weights/freight_added", &Ofp::freight},
+    {"OFP/times/est_out", &Ofp::est_out},
+    {"OFP/times/est_off", &Ofp::est_off},
+    {"OFP/times/est_on", &Ofp::est_on},
+    {"OFP/times/est_in", &Ofp::est_in},
+};
+
+static constexpr unsigned kXmlAll = (1 << std::size(xml_fields)) - 1;
+
+// decode the predefined entities in place
+static void DecodeEntities(std::string& str) {
+    size_t out = str.find('&');
+    if (out == std::string::npos)
+        return;
+
+    static const struct {
+        const char *ent;
+        char c;
+    } ents[] = {{"&amp;", '&'}, {"&lt;", '<'}, {"&gt;", '>'}, {"&quot;", '"'}, {"&apos;", '\''}};
+
+    size_t i = out;
+    while (i < str.size()) {
+        if (str[i] == '&') {
+            auto e = std::find_if(std::begin(ents), std::end(ents),
+                                  [&](const auto& e) { return str.compare(i, strlen(e.ent), e.ent) == 0; });
+            if (e != std::end(ents)) {
+                str[out++] = e->c;
+                i += strlen(e->ent);
+                continue;
+            }
+        }
+
+        str[out++] = str[i++];
+    }
+
+    str.resize(out);
+}
+
+OfpXmlParser::OfpXmlParser(Ofp& ofp)
+    : ofp_(ofp), field_(nullptr), found_(0), markup_(kText), quote_(0) {
+    path_.reserve(128);
+    tag_.reserve(64);
+}
+
+bool OfpXmlParser::Done() const {
+    return found_ == kXmlAll && field_ == nullptr;
+}
+
+// process the complete tag in tag_
+void OfpXmlParser::Tag() {
+    // declarations, e.g. <!DOCTYPE ...>
+    if (tag_.empty() || tag_[0] == '?' || tag_[0] == '!')
+        return;
+
+    if (tag_[0] == '/') {
+        if (field_) {
+            DecodeEntities(*field_);
+            field_ = nullptr;
+        }
+
+        size_t slash = path_.rfind('/');
+        path_.resize(slash == std::string::npos ? 0 : slash);
+        return;
+    }
+
+    bool empty_elem = (tag_.back() == '/');
+    size_t len = path_.size();
+    if (len > 0)
+        path_ += '/';
+    path_.append(tag_, 0, tag_.find_first_of(" \t\r\n/"));
+
+    for (unsigned i = 0; i < std::size(xml_fields); i++) {
+        if (!(found_ & (1 << i)) && path_ == xml_fields[i].path) {
+            found_ |= 1 << i;
+            std::string& field = ofp_.*xml_fields[i].field;
+            field.clear();
+            if (!empty_elem)
+                field_ = &field;
+            break;
+        }
+    }
+
+    if (empty_elem)
+        path_.resize(len);
+}
+
+// consume markup from data up to and including its end or end of data
+void OfpXmlParser::ScanMarkup(const char *&data, const char *end) {
+    if (markup_ == kTag) {
+        while (data < end) {
+            // the first chars tell comments, CDATA and PIs from tags and declarations
+            char first = tag_.empty() ? *data : tag_[0];
+            bool probe = tag_.size() < 8 && (first == '!' || first == '?');
+            const char *p = data;
+
+            // most tags have no attributes
+            if (!probe && !quote_) {
+                const char *gt = (const char *)memchr(data, '>', end - data);
+                const char *e = gt ? gt : end;
+                if (!memchr(data, '"', e - data) && !memchr(data, '\'', e - data))
+                    p = e;
+            }
+
+            for (; p < end; p++) {
+                if (quote_) {
+                    if (*p == quote_)
+                        quote_ = 0;
+                } else if (*p == '"' || *p == '\'') {
+                    quote_ = *p;
+                } else if (*p == '>') {
+                    break;
+                }
+
+                if (probe) {
+                    p++;
+                    break;
+                }
+            }
+
+            tag_.append(data, p - data);
+            data = p;
+            if (probe && !quote_ && (tag_[0] == '!' || tag_[0] == '?')) {
+                Markup m = (tag_ == "!--") ? kComment : (tag_ == "![CDATA[") ? kCdata : (tag_ == "?") ? kPi : kTag;
+                if (m != kTag) {
+                    markup_ = m;
+                    tag_.clear();
+                    return;
+                }
+            }
+
+            if (data < end && *data == '>' && !quote_) {
+                data++;
+                markup_ = kText;
+                Tag();
+                tag_.clear();
+                return;
+            }
+        }
+
+        return;
+    }
 
+    // comment, CDATA or PI, the chars that may start the terminator are held back in tag_
+    const char *term = (markup_ == kComment) ? "--" : (markup_ == kCdata) ? "]]" : "?";
+    size_t n_term = strlen(term);
+    for (; data < end; data++) {
+        char c = *data;
+        if (c == '>' && tag_ == term) {
+            data++;
+            markup_ = kText;
+            tag_.clear();
+            return;
+        }
+
+        tag_ += c;
+        if (tag_.size() > n_term) {
+            // text of CDATA is literal, escape '&' for DecodeEntities()
+            if (markup_ == kCdata && field_) {
+                if (tag_[0] == '&')
+                    field_->append("&amp;");
+                else
+                    *field_ += tag_[0];
+            }
+            tag_.erase(0, 1);
+        }
+    }
+}
+
+bool OfpXmlParser::Feed(const char *data, size_t len) {
+    const char *end = data + len;
+    while (data < end && !Done()) {
+        if (markup_ != kText) {
+            ScanMarkup(data, end);
+        } else {
+            const char *lt = (const char *)memchr(data, '<', end - data);
+            if (field_)
+                field_->append(data, (lt ? lt : end) - data);
+            if (lt == nullptr)
+                break;
+
+            markup_ = kTag;
+            data = lt + 1;
+        }
+    }
+
+    // never abort the transfer, the rest is skipped cheaply
+    return true;
+}
+
+std::unique_ptr<Ofp> Ofp::FetchDirect(const std::string& pilot_id, int timeout, const std::atomic<bool> *abort) {
+    TraceSpan("Ofp::FetchDirect");
+    bool numeric = !pilot_id.empty() &&
+                   std::all_of(pilot_id.begin(), pilot_id.end(), [](char c) { return isdigit((unsigned char)c); });
+    std::string url = std::string("https://www.simbrief.com/api/xml.fetcher.php?")
+                      + (numeric ? "userid=" : "username=") + HttpUrlEncode(pilot_id);
+
+    auto ofp = std::make_unique<Ofp>();
+    OfpXmlParser parser(*ofp);
+    bool ok = HttpDefaultClient().Get(url, [&parser](const char *data, size_t len) { return parser.Feed(data, len); },
+                                      timeout, abort);
+    if (!ok || parser.Empty()) {
+        LogMsg("Can't fetch OFP from SimBrief for '%s'", pilot_id.c_str());
+        return nullptr;
+    }
+
+    ofp->seqno = ++my_seqno;
+    LogMsg("From SimBrief: Seqno: %d", ofp->seqno);
+    LogFields(*ofp, kOfpGroup);
     return ofp;
 }
 
-const std::string Ofp::GenDepartureStr() const {
-    std::string str;
-    str = icao_airline + flight_number + " " + aircraft_icao + " TO " + destination;
+OfpLoader::OfpLoader(const std::string& pilot_id, float hub_interval, float fetch_interval)
+    : pilot_id_(pilot_id), hub_interval_(hub_interval), fetch_interval_(fetch_interval),
+      next_check_(0.0f), busy_(false), refresh_(false), stop_(false), fetched_(0) {
+}
+
+OfpLoader::~OfpLoader() {
+    Stop();
+}
+
+void OfpLoader::Stop() {
+    stop_ = true;
+    if (thread_.joinable())
+        thread_.join();
+}
+
+void OfpLoader::Publish(std::shared_ptr<const Ofp> ofp) {
+    std::atomic_store_explicit(&ofp_, std::move(ofp), std::memory_order_release);
+}
+
+void OfpLoader::Refresh() {
+    refresh_ = true;
+}
+
+unsigned OfpLoader::Poll(float now) {
+    unsigned changed = fetched_.exchange(0);
+    if (stop_ || (now < next_check_ && !refresh_))
+        return changed;
+
+    // a check starts, so a pending refresh is served now
+    bool refresh = refresh_.exchange(false);
+
+    if (Ofp::HubAvailable()) {
+        next_check_ = now + hub_interval_;
+        unsigned mask = work_.UpdateIfNewer();
+        if (mask) {
+            Publish(std::make_shared<const Ofp>(work_));
+            changed |= mask;
+        }
+
+        if (Ofp::HubAvailable())
+            return changed;
+    }
+
+    if (pilot_id_.empty())
+        return changed;
+
+    if (busy_) {
+        if (refresh)
+            refresh_ = true;    // retry when the fetch in flight has finished
+        return changed;
+    }
+
+    next_check_ = now + fetch_interval_;
+
+    // the previous fetch has finished
+    if (thread_.joinable())
+        thread_.join();
+
+    busy_ = true;
+    thread_ = std::thread([this, pilot_id = pilot_id_] {
+        auto ofp = Ofp::FetchDirect(pilot_id, 10, &stop_);
+        if (ofp && !stop_) {
+            auto cur = Get();
+            unsigned mask = cur ? ofp->Diff(*cur) : (Ofp::kOfpGroup | Ofp::kCdmGroup);
+            if (mask) {
+                Publish(std::move(ofp));
+                fetched_ |= mask;
+            }
+        }
+        busy_ = false;
+    });
+    return changed;
+}
+
+OfpLoader& OfpSharedLoader() {
+    HttpDefaultClient();    // construct it first, so it is destroyed after the loader
+    static OfpLoader loader;
+    return loader;
+}
+
+struct OfpSub {
+    unsigned mask;
+    bool initial;       // current OFP not yet delivered
+    OfpCallback callback;
+};
+
+static std::map<OfpSubscription, OfpSub> subs;
+static OfpSubscription next_sub_id;
+static bool flight_loop_active;
+
+static float OfpFlightLoopCb(float, float, int, void*) {
+    unsigned changed = OfpSharedLoader().Poll(XPLMGetElapsedTime());
+    auto ofp = OfpSharedLoader().Get();
+    if (!ofp)
+        return 1.0f;
+
+    // callbacks may unsubscribe themselves or others, so collect the ids first
+    // and skip those that are gone by the time they are due
+    std::vector<std::pair<OfpSubscription, unsigned>> calls;
+    for (auto& s : subs) {
+        unsigned mask = s.second.initial ? (Ofp::kOfpGroup | Ofp::kCdmGroup) : (changed & s.second.mask);
+        s.second.initial = false;
+        if (mask)
+            calls.emplace_back(s.first, mask);
+    }
+
+    for (auto& c : calls) {
+        auto it = subs.find(c.first);
+        if (it == subs.end())
+            continue;
+
+        OfpCallback cb = it->second.callback;   // survives if it unsubscribes itself
+        cb(ofp, c.second);
+    }
+
+    return 1.0f;
+}
+
+OfpSubscription OfpSubscribe(unsigned mask, OfpCallback callback) {
+    OfpSubscription id = ++next_sub_id;
+    subs[id] = {mask, true, std::move(callback)};
+
+    if (!flight_loop_active) {
+        XPLMRegisterFlightLoopCallback(OfpFlightLoopCb, 1.0f, nullptr);
+        flight_loop_active = true;
+    }
+
+    return id;
+}
+
+void OfpUnsubscribe(OfpSubscription id) {
+    subs.erase(id);
+    if (subs.empty() && flight_loop_active) {
+        XPLMUnregisterFlightLoopCallback(OfpFlightLoopCb, nullptr);
+        flight_loop_active = false;
+    }
+}
+
+// appends to a fixed buffer, counts what does not fit
+struct StrBuf {
+    char *buf;
+    size_t size;
+    size_t len;
+
+    void Put(const char *str, size_t n) {
+        if (len + 1 < size) {
+            size_t m = std::min(n, size - 1 - len);
+            memcpy(buf + len, str, m);
+            buf[len + m] = '\0';
+        }
+        len += n;
+    }
+
+    void Put(const std::string& str) { Put(str.data(), str.size()); }
+
+    template <size_t N>
+    void Put(const char (&str)[N]) { Put(str, N - 1); }
+
+    // HHMM (UTC) of a unix time in a string, parsed like atol() + gmtime()
+    void Hhmm(const std::string& unix_time) {
+        const char *p = unix_time.c_str();
+        while (isspace((unsigned char)*p))
+            p++;
+
+        bool neg = (*p == '-');
+        if (*p == '-' || *p == '+')
+            p++;
+
+        // 18 digits can't overflow, that's far beyond any representable date anyway
+        int64_t t = 0;
+        for (int i = 0; i < 18 && *p >= '0' && *p <= '9'; i++, p++)
+            t = t * 10 + (*p - '0');
+
+        int sod = (neg ? -t : t) % 86400;
+        if (sod < 0)
+            sod += 86400;
+        int hh = sod / 3600, mm = (sod / 60) % 60;
+        char hhmm[4] = {char('0' + hh / 10), char('0' + hh % 10), char('0' + mm / 10), char('0' + mm % 10)};
+        Put(hhmm, 4);
+    }
+};
+
+size_t Ofp::GenDepartureStr(char *buf, size_t size) const {
+    StrBuf sb{buf, size, 0};
+    if (size > 0)
+        buf[0] = '\0';
 
-    time_t out_time = atol(est_out.c_str());
-    time_t off_time = atol(est_off.c_str());
+    sb.Put(icao_airline);
+    sb.Put(flight_number);
+    sb.Put(" ");
+    sb.Put(aircraft_icao);
+    sb.Put(" TO ");
+    sb.Put(destination);
 
-    bool have_cdm{false};
     if (cdm_tobt.empty()) {
-        auto out_tm = *std::gmtime(&out_time);
-        char out[20];
-        strftime(out, sizeof(out), " OUT %H%M", &out_tm);
-        str.append(out);
+        sb.Put(" OUT ");
+        sb.Hhmm(est_out);
+        sb.Put(" OFF ");
+        sb.Hhmm(est_off);
     } else {
-        have_cdm = true;
         if (cdm_tsat != cdm_tobt) {
-            str.append(" TOBT " + cdm_tobt);
+            sb.Put(" TOBT ");
+            sb.Put(cdm_tobt);
         }
 
         if (!cdm_tsat.empty()) {
-            str.append(" TSAT " + cdm_tsat);
+            sb.Put(" TSAT ");
+            sb.Put(cdm_tsat);
         }
 
         if (!cdm_ctot.empty()) {
-            str.append(" CTOT " + cdm_ctot);
+            sb.Put(" CTOT ");
+            sb.Put(cdm_ctot);
         }
     }
 
-    if (!have_cdm) {
-        auto off_tm = *std::gmtime(&off_time);
-        char off[20];
-        strftime(off, sizeof(off), " OFF %H%M", &off_tm);
-        str.append(off);
+    if (!cdm_runway.empty()) {
+        sb.Put(" RWY ");
+        sb.Put(cdm_runway);
     }
 
-    if (!cdm_runway.empty())
-        str.append(" RWY " + cdm_runway);
+    if (!cdm_sid.empty()) {
+        sb.Put(" SID ");
+        sb.Put(cdm_sid);
+    }
+
+    return sb.len;
+}
 
-    if (!cdm_sid.empty())
-        str.append(" SID " + cdm_sid);
+std::string Ofp::GenDepartureStr() const {
+    char buf[128];
+    size_t len = GenDepartureStr(buf, sizeof(buf));
+    if (len < sizeof(buf))
+        return std::string(buf, len);
 
+    std::string str(len, '\0');
+    GenDepartureStr(str.data(), len + 1);
     return str;
 }
+
+const char *DepartureStrCache::Get(const Ofp& ofp) {
+    if (ofp.seqno != seqno_) {
+        ofp.GenDepartureStr(str_, sizeof(str_));
+        seqno_ = ofp.seqno;
+    }
+
+    return str_;
+}
@@ -22,14 +22,20 @@
 #ifndef _SIMBRIEF_H_
 #define _SIMBRIEF_H_
 
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <string>
+#include <thread>
 
 #define F(f) std::string f
 
 struct Ofp
 {
-    int seqno;          // incremented after each successfull fetch
+    int seqno{0};       // incremented after each successfull fetch
+    int src_seqno{0};   // simbrief_hub versions the fields were read from
+    int src_cdm_seqno{0};
+
     F(icao_airline);
     F(flight_number);
     F(aircraft_icao);
@@ -49,13 +55,162 @@ struct Ofp
     F(cdm_runway);
     F(cdm_sid);
 
+    // bits of a change mask
+    enum : unsigned {
+        kIcaoAirline = 1 << 0,
+        kFlightNumber = 1 << 1,
+        kAircraftIcao = 1 << 2,
+        kDestination = 1 << 3,
+        kPaxCount = 1 << 4,
+        kFreight = 1 << 5,
+        kEstOut = 1 << 6,
+        kEstOff = 1 << 7,
+        kEstOn = 1 << 8,
+        kEstIn = 1 << 9,
+        kDxRmk = 1 << 10,
+        kCdmTobt = 1 << 11,
+        kCdmTsat = 1 << 12,
+        kCdmCtot = 1 << 13,
+        kCdmRunway = 1 << 14,
+        kCdmSid = 1 << 15,
+
+        kOfpGroup = (1 << 11) - 1,
+        kCdmGroup = ((1 << 5) - 1) << 11
+    };
+
     // return ptr to an OFP if a newer version is available or nullptr
     static std::unique_ptr<Ofp> LoadIfNewer(int cur_seqno);
 
+    // Update in place if a newer version is available, the string capacity is reused.
+    // Only the group (OFP or CDM) whose seqno changed is read. With an older simbrief_hub
+    // without seqnos all fields are read and compared.
+    // Returns a mask of the fields that differ, 0 if nothing changed.
+    unsigned UpdateIfNewer();
+
+    // true unless the simbrief_hub plugin was found to be missing
+    static bool HubAvailable();
+
+    // Fallback if simbrief_hub is not available: fetch the latest OFP of a SimBrief
+    // pilot id (numeric) or user name directly. Blocking, so better not call it from a flight loop.
+    // The fetch is aborted when *abort becomes true.
+    // Returns ptr to an OFP or nullptr.
+    static std::unique_ptr<Ofp> FetchDirect(const std::string& pilot_id, int timeout = 10,
+                                            const std::atomic<bool> *abort = nullptr);
+
+    // return mask of the fields that differ from other
+    unsigned Diff(const Ofp& other) const;
+
     // generate a string to be displayed in a VDGS
-    const std::string GenDepartureStr() const;
+    std::string GenDepartureStr() const;
+
+    // Same into buf without allocations, the result is 0 terminated and truncated if necessary.
+    // Returns the length of the complete string like snprintf.
+    size_t GenDepartureStr(char *buf, size_t size) const;
 };
 
 #undef F
 
+// Keeps the departure string of an OFP, it's only rebuilt when the seqno changes.
+class DepartureStrCache {
+    int seqno_{-1};
+    char str_[128];
+
+  public:
+    const char *Get(const Ofp& ofp);
+};
+
+// Single pass streaming extraction of the Ofp fields from a SimBrief XML OFP.
+// Only the text of the wanted elements is kept, the rest of the document is skipped.
+// Comments, processing instructions, CDATA sections (as text) and '>' in quoted
+// attribute values are handled. Feed() can be used as HttpSink.
+class OfpXmlParser {
+    enum Markup { kText, kTag, kComment, kCdata, kPi };
+
+    Ofp& ofp_;
+    std::string path_;          // e.g. "OFP/general/icao_airline"
+    std::string tag_;           // or the held back chars of a comment, CDATA or PI end
+    std::string *field_;        // field that receives text or nullptr
+    unsigned found_;
+    Markup markup_;             // where the parser is
+    char quote_;                // of an attribute value in a tag or 0
+
+    void ScanMarkup(const char *&data, const char *end);
+
+    void Tag();
+
+  public:
+    explicit OfpXmlParser(Ofp& ofp);
+
+    bool Feed(const char *data, size_t len);
+
+    bool Done() const;          // all fields found
+    bool Empty() const { return found_ == 0; }
+};
+
+// Keeps the latest OFP as an immutable snapshot.
+// Readers only load a shared_ptr and never block on a refresh.
+//
+// With simbrief_hub the hub's seqnos are checked every hub_interval s. Datarefs can
+// only be read from the main thread, so Poll() must be called from a flight loop.
+// Without simbrief_hub but with a pilot id the OFP is fetched directly in a
+// background thread every fetch_interval s, at most one fetch is in flight.
+// Call Stop() before the plugin is unloaded, e.g. in XPluginStop.
+class OfpLoader {
+    std::shared_ptr<const Ofp> ofp_;        // accessed with std::atomic_load/store only
+    Ofp work_;                              // hub data, updated in place
+    std::string pilot_id_;
+    float hub_interval_, fetch_interval_;
+    float next_check_;
+    std::atomic<bool> busy_;                // direct fetch in flight
+    std::atomic<bool> refresh_;
+    std::atomic<bool> stop_;
+    std::atomic<unsigned> fetched_;         // change mask of the last direct fetch
+    std::thread thread_;
+
+    void Publish(std::shared_ptr<const Ofp> ofp);
+
+  public:
+    explicit OfpLoader(const std::string& pilot_id = "", float hub_interval = 2.0f, float fetch_interval = 300.0f);
+    ~OfpLoader();
+
+    OfpLoader(const OfpLoader&) = delete;
+    OfpLoader& operator=(const OfpLoader&) = delete;
+
+    // Call from a flight loop, now is e.g. the flight loop's elapsed time.
+    // Returns the mask of fields changed since the last call.
+    unsigned Poll(float now);
+
+    // fetch directly at the next Poll()
+    void Refresh();
+
+    // Abort a fetch in flight and wait for its thread, no more fetches are started.
+    // Call it from the main thread.
+    void Stop();
+
+    // for the direct fetch, call from the main thread
+    void SetPilotId(const std::string& pilot_id) { pilot_id_ = pilot_id; }
+
+    // current snapshot or nullptr, can be called from any thread
+    std::shared_ptr<const Ofp> Get() const {
+        return std::atomic_load_explicit(&ofp_, std::memory_order_acquire);
+    }
+};
+
+// Change subscriptions
+//
+// All subscribers share OfpSharedLoader() that is polled by a single flight loop
+// every second, with the loader's own rate for hub checks and fetches. Changes within a
+// poll interval are delivered as one call with the combined mask. A new subscriber first
+// gets the current OFP, if any. The flight loop only runs while there are subscribers.
+// Callbacks are called from the flight loop and may unsubscribe.
+// Call OfpSharedLoader().Stop() in XPluginStop.
+typedef std::function<void(const std::shared_ptr<const Ofp>& ofp, unsigned changed)> OfpCallback;
+typedef int OfpSubscription;        // 0 is not a valid id
+
+// subscribe to changes of the fields in mask, e.g. Ofp::kOfpGroup or Ofp::kCdmGroup
+extern OfpSubscription OfpSubscribe(unsigned mask, OfpCallback callback);
+extern void OfpUnsubscribe(OfpSubscription id);
+
+extern OfpLoader& OfpSharedLoader();
+
 #endif
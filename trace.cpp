@@ -0,0 +1,213 @@
+//
+//    Copyright (C) 2026 Holger Teutsch
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 2.1 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+//    USA
+//
+
+#include <cstdio>
+#include <cstring>
+
+#include "trace.h"
+#include "log_msg.h"
+
+// Events of a thread are kept in a ring, the oldest ones are overwritten.
+// Buffers are kept until TraceShutdown() so the spans of terminated threads can still be dumped.
+static constexpr int kTraceBufEvents = 32 * 1024;
+
+struct TraceEvent {
+    const TraceSite *site;
+    int64_t start;
+    int64_t end;
+};
+
+struct TraceBuffer {
+    int tid;
+    TraceBuffer *next;
+    std::atomic<uint64_t> n;   // # of events ever written
+    TraceEvent ev[kTraceBufEvents];
+};
+
+std::atomic<bool> trace_active;
+
+static int64_t trace_t0;
+static std::atomic<int> n_buffers;
+static std::atomic<TraceBuffer *> buffers;
+static std::atomic<TraceSite *> sites;
+static std::atomic<int> trace_gen;     // incremented by TraceShutdown()
+static thread_local TraceBuffer *tbuf;
+static thread_local int tbuf_gen;
+
+// lock free push to a singly linked list
+template <typename T>
+static void Push(std::atomic<T *>& head, T *elem) {
+    T *h = head.load(std::memory_order_relaxed);
+    do {
+        elem->next = h;
+    } while (!head.compare_exchange_weak(h, elem, std::memory_order_release, std::memory_order_relaxed));
+}
+
+static inline int Bucket(uint64_t d) {
+    if (d < (1 << kTraceSubBits))
+        return d;
+
+    int msb = 63 - __builtin_clzll(d);
+    int sub = (d >> (msb - kTraceSubBits)) & ((1 << kTraceSubBits) - 1);
+    return ((msb - kTraceSubBits + 1) << kTraceSubBits) + sub;
+}
+
+// lower bound of a bucket in ns
+static inline uint64_t BucketValue(int b) {
+    if (b < (1 << kTraceSubBits))
+        return b;
+
+    int msb = (b >> kTraceSubBits) + kTraceSubBits - 1;
+    uint64_t sub = b & ((1 << kTraceSubBits) - 1);
+    return (uint64_t{1} << msb) | (sub << (msb - kTraceSubBits));
+}
+
+void TraceRecord(TraceSite& site, int64_t start, int64_t end) {
+    if (!site.registered.load(std::memory_order_acquire) && !site.registered.exchange(true))
+        Push(sites, &site);
+
+    uint64_t d = end - start;
+    site.count.fetch_add(1, std::memory_order_relaxed);
+    site.sum_ns.fetch_add(d, std::memory_order_relaxed);
+    site.hist[Bucket(d)].fetch_add(1, std::memory_order_relaxed);
+
+    // min is stored + 1 so 0 means unset
+    uint64_t cur = site.min_ns.load(std::memory_order_relaxed);
+    while ((cur == 0 || d + 1 < cur) &&
+           !site.min_ns.compare_exchange_weak(cur, d + 1, std::memory_order_relaxed))
+        ;
+
+    cur = site.max_ns.load(std::memory_order_relaxed);
+    while (d > cur && !site.max_ns.compare_exchange_weak(cur, d, std::memory_order_relaxed))
+        ;
+
+    // a buffer of before TraceShutdown() is gone
+    int gen = trace_gen.load(std::memory_order_acquire);
+    if (tbuf == nullptr || tbuf_gen != gen) {
+        tbuf = new TraceBuffer();
+        tbuf_gen = gen;
+        tbuf->tid = n_buffers.fetch_add(1) + 1;
+        Push(buffers, tbuf);
+    }
+
+    uint64_t n = tbuf->n.load(std::memory_order_relaxed);
+    tbuf->ev[n % kTraceBufEvents] = {&site, start, end};
+    tbuf->n.store(n + 1, std::memory_order_release);
+}
+
+void TraceEnable(bool on) {
+    if (on && trace_t0 == 0)
+        trace_t0 = TraceNow();
+    trace_active.store(on);
+}
+
+// write str with quotes, backslashes and control characters escaped for a JSON string
+static void PutJsonStr(FILE *f, const char *str) {
+    for (const unsigned char *p = (const unsigned char *)str; *p; p++) {
+        if (*p == '"' || *p == '\\')
+            fprintf(f, "\\%c", *p);
+        else if (*p < 0x20)
+            fprintf(f, "\\u%04x", *p);
+        else
+            putc(*p, f);
+    }
+}
+
+// Spans that are recorded while dumping may be missed or show up garbled.
+// So best call this when tracing is disabled or from the thread that records the most.
+bool TraceDump(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (f == nullptr) {
+        LogMsg("Can't create trace file '%s'", path);
+        return false;
+    }
+
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", f);
+    bool first = true;
+    int n_ev = 0;
+
+    for (TraceBuffer *b = buffers.load(std::memory_order_acquire); b; b = b->next) {
+        fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",
+                first ? "" : ",\n", b->tid, b->tid);
+        first = false;
+
+        uint64_t n = b->n.load(std::memory_order_acquire);
+        uint64_t i = (n > kTraceBufEvents) ? n - kTraceBufEvents : 0;
+        for (; i < n; i++) {
+            const TraceEvent& e = b->ev[i % kTraceBufEvents];
+            fputs(",\n{\"name\":\"", f);
+            PutJsonStr(f, e.site->name);
+            fputs("\",\"cat\":\"", f);
+            PutJsonStr(f, e.site->file);
+            fprintf(f, "\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d,\"args\":{\"line\":%d}}",
+                    (e.start - trace_t0) * 1.0E-3, (e.end - e.start) * 1.0E-3, b->tid, e.site->line);
+            n_ev++;
+        }
+    }
+
+    fputs("\n]}\n", f);
+    fclose(f);
+    LogMsg("%d trace events written to '%s'", n_ev, path);
+    return true;
+}
+
+void TraceShutdown() {
+    trace_active.store(false);
+    trace_gen.fetch_add(1, std::memory_order_release);
+
+    TraceBuffer *b = buffers.exchange(nullptr, std::memory_order_acquire);
+    int n = 0;
+    while (b) {
+        TraceBuffer *next = b->next;
+        delete b;
+        b = next;
+        n++;
+    }
+
+    LogMsg("%d trace buffers freed", n);
+}
+
+void TraceLogStats() {
+    for (TraceSite *s = sites.load(std::memory_order_acquire); s; s = s->next) {
+        uint64_t count = s->count.load(std::memory_order_relaxed);
+        if (count == 0)
+            continue;
+
+        // p99 from the histogram
+        uint64_t limit = count - count / 100;
+        uint64_t acc = 0;
+        int b = 0;
+        for (; b < kTraceBuckets - 1; b++) {
+            acc += s->hist[b].load(std::memory_order_relaxed);
+            if (acc >= limit)
+                break;
+        }
+
+        uint64_t max_ns = s->max_ns.load(std::memory_order_relaxed);
+        uint64_t p99_ns = BucketValue(b + 1);
+        if (p99_ns > max_ns)
+            p99_ns = max_ns;
+
+        LogMsg("trace %s (%s:%d): n: %llu, min: %.3f, avg: %.3f, p99: %.3f, max: %.3f ms",
+               s->name, s->file, s->line, (unsigned long long)count,
+               (s->min_ns.load(std::memory_order_relaxed) - 1) * 1.0E-6,
+               s->sum_ns.load(std::memory_order_relaxed) * 1.0E-6 / count,
+               p99_ns * 1.0E-6, max_ns * 1.0E-6);
+    }
+}
@@ -0,0 +1,113 @@
+//
+//    Copyright (C) 2026 Holger Teutsch
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 2.1 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+//    USA
+//
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+// Scoped profiling spans
+//
+// void MyFunc() {
+//     TraceSpan("MyFunc");
+//     ...
+// }
+//
+// Spans are recorded into per thread buffers while tracing is enabled and
+// can be written as Chrome/Perfetto JSON (load in ui.perfetto.dev or chrome://tracing).
+// In addition each span keeps count, min, avg, p99 and max of its duration.
+//
+// TraceEnable(true);               // e.g. in XPluginEnable
+// ...
+// TraceLogStats();                 // e.g. in XPluginStop
+// TraceDump("Output/my_plugin_trace.json");
+// TraceShutdown();
+//
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// duration histogram: 4 sub buckets per power of 2 of ns
+static constexpr int kTraceSubBits = 2;
+static constexpr int kTraceBuckets = 64 << kTraceSubBits;
+
+struct TraceSite {
+    const char *name;
+    const char *file;
+    int line;
+
+    std::atomic<bool> registered{false};
+    TraceSite *next{nullptr};
+
+    std::atomic<uint64_t> count{0}, sum_ns{0}, min_ns{0}, max_ns{0};
+    std::atomic<uint32_t> hist[kTraceBuckets]{};
+};
+
+// functions
+extern void TraceEnable(bool on);
+extern bool TraceDump(const char *path);    // write recorded spans as JSON
+extern void TraceLogStats();                // log aggregates of all spans
+
+// Disable tracing and free the buffers of all threads, e.g. in XPluginStop after TraceDump().
+// No span must run concurrently or afterwards until tracing is enabled again.
+extern void TraceShutdown();
+
+extern std::atomic<bool> trace_active;
+
+static inline int64_t TraceNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+extern void TraceRecord(TraceSite& site, int64_t start, int64_t end);
+
+class TraceTimer {
+    TraceSite *site_;
+    int64_t start_{0};
+
+  public:
+    explicit TraceTimer(TraceSite& site)
+        : site_(trace_active.load(std::memory_order_relaxed) ? &site : nullptr) {
+        if (site_)
+            start_ = TraceNow();
+    }
+
+    ~TraceTimer() {
+        if (site_)
+            TraceRecord(*site_, start_, TraceNow());
+    }
+
+    TraceTimer(const TraceTimer&) = delete;
+    TraceTimer& operator=(const TraceTimer&) = delete;
+};
+
+#define TRACE_CAT_(a, b) a##b
+#define TRACE_CAT(a, b) TRACE_CAT_(a, b)
+
+#ifdef __FILE_NAME__
+#define TRACE_FILE __FILE_NAME__
+#else
+#define TRACE_FILE __FILE__
+#endif
+
+// time the enclosing scope
+#define TraceSpan(name)                                                                 \
+    static TraceSite TRACE_CAT(trace_site_, __LINE__){name, TRACE_FILE, __LINE__};      \
+    TraceTimer TRACE_CAT(trace_timer_, __LINE__)(TRACE_CAT(trace_site_, __LINE__))
+
+#endif
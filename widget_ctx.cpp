@@ -19,12 +19,19 @@
 
 #include "widget_ctx.h"
 
-#include "XPLMDataAccess.h"
 #include "XPLMDisplay.h"
 
+#include "dataref.h"
 #include "log_msg.h"
+#include "trace.h"
 
-static XPLMDataRef vr_enabled_dr;
+struct VrState {
+    int enabled;
+};
+
+static VrState vr;
+static DrefRegistry<VrState> vr_drefs;
+static bool vr_resolved;
 
 void WidgetCtx::Set(XPWidgetID widget_, int left, int top, int width, int height) {
     widget = widget_;
@@ -35,8 +42,13 @@ void WidgetCtx::Set(XPWidgetID widget_, int left, int top, int width, int height
 }
 
 void WidgetCtx::Show() {
-    if (vr_enabled_dr == nullptr)
-        vr_enabled_dr = XPLMFindDataRef("sim/graphics/VR/enabled");
+    TraceSpan("WidgetCtx::Show");
+    // retried until found
+    if (!vr_resolved) {
+        if (vr_drefs.Size() == 0)
+            vr_drefs.Bind<&VrState::enabled>("sim/graphics/VR/enabled");
+        vr_resolved = vr_drefs.Resolve();
+    }
 
     if (XPIsWidgetVisible(widget))
         return;
@@ -58,7 +70,8 @@ void WidgetCtx::Show() {
     XPSetWidgetGeometry(widget, l, t, l + w, t - h);
     XPShowWidget(widget);
 
-    int in_vr = (NULL != vr_enabled_dr) && XPLMGetDatai(vr_enabled_dr);
+    vr_drefs.Read(vr);
+    int in_vr = vr.enabled;
     if (in_vr) {
         LogMsg("VR mode detected");
         XPLMWindowID window = XPGetWidgetUnderlyingWindow(widget);
@@ -0,0 +1,294 @@
+//
+//    Copyright (C) 2026 Holger Teutsch
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 2.1 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+//    USA
+//
+
+#include "xplm_stub.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <memory>
+
+#include "XPLMDataAccess.h"
+#include "XPLMDisplay.h"
+#include "XPLMProcessing.h"
+#include "XPLMUtilities.h"
+#include "XPWidgets.h"
+
+namespace {
+
+struct Dref {
+    bool present;
+    int i;
+    float f;
+    double d;
+    std::vector<int> vi;
+    std::vector<float> vf;
+    std::string b;
+};
+
+struct FlightLoop {
+    XPLMFlightLoop_f cb;
+    void *refcon;
+    float next;         // time of the next call
+    float last;         // time of the last call
+    int counter;
+};
+
+struct Action {
+    float t;
+    std::function<void()> action;
+};
+
+// handles must stay valid, so entries are never erased but Remove()d
+std::map<std::string, std::unique_ptr<Dref>> drefs;
+std::map<void *, xplm_stub::Widget> widgets;
+std::vector<FlightLoop> flight_loops;
+std::vector<Action> actions;
+float now;
+int screen[4] = {0, 1080, 1920, 0};
+xplm_stub::Counters counters;
+FILE *debug_out = stdout;
+
+Dref& Get(const std::string& name) {
+    auto& dr = drefs[name];
+    if (!dr)
+        dr = std::make_unique<Dref>();
+    dr->present = true;
+    return *dr;
+}
+
+void SetScalar(const std::string& name, int i, float f, double d) {
+    Dref& dr = Get(name);
+    dr.i = i;
+    dr.f = f;
+    dr.d = d;
+}
+
+xplm_stub::Widget& GetWidget(XPWidgetID id) {
+    counters.widget++;
+    return widgets[id];
+}
+
+// copy n values from offset of src into dst, XPLMGetDatav* semantics
+template <typename T>
+int GetArray(const std::vector<T>& src, T *dst, int offset, int max) {
+    if (dst == nullptr)
+        return src.size();
+
+    int n = std::clamp((int)src.size() - offset, 0, max);
+    if (n > 0)
+        memcpy(dst, src.data() + offset, n * sizeof(T));
+    return n;
+}
+
+}  // namespace
+
+namespace xplm_stub {
+
+void SetInt(const std::string& name, int val) { SetScalar(name, val, val, val); }
+void SetFloat(const std::string& name, float val) { SetScalar(name, (int)val, val, val); }
+void SetDouble(const std::string& name, double val) { SetScalar(name, (int)val, (float)val, val); }
+void SetString(const std::string& name, const std::string& val) { Get(name).b = val; }
+void SetInts(const std::string& name, const std::vector<int>& val) { Get(name).vi = val; }
+void SetFloats(const std::string& name, const std::vector<float>& val) { Get(name).vf = val; }
+
+void Remove(const std::string& name) {
+    auto it = drefs.find(name);
+    if (it != drefs.end())
+        *it->second = Dref();
+}
+
+void SetScreenBounds(int left, int top, int right, int bottom) {
+    screen[0] = left;
+    screen[1] = top;
+    screen[2] = right;
+    screen[3] = bottom;
+}
+
+void SetVr(bool enabled) { SetInt("sim/graphics/VR/enabled", enabled); }
+
+Widget GetWidget(void *widget) {
+    auto it = widgets.find(widget);
+    return it != widgets.end() ? it->second : Widget();
+}
+
+void SetDebugOutput(FILE *f) { debug_out = f; }
+
+float Now() { return now; }
+
+void At(float t, std::function<void()> action) {
+    actions.push_back({t, std::move(action)});
+}
+
+void Run(float duration, float frame_time) {
+    float end = now + duration;
+    while (now < end) {
+        now += frame_time;
+
+        // actions may add actions
+        for (size_t i = 0; i < actions.size();) {
+            if (actions[i].t <= now) {
+                auto action = std::move(actions[i].action);
+                actions.erase(actions.begin() + i);
+                action();
+            } else {
+                i++;
+            }
+        }
+
+        // callbacks may (un)register flight loops, so work on a copy
+        auto loops = flight_loops;
+        for (auto& fl : loops) {
+            if (fl.next <= 0.0f || fl.next > now)
+                continue;
+
+            auto it = std::find_if(flight_loops.begin(), flight_loops.end(), [&fl](const FlightLoop& l) {
+                return l.cb == fl.cb && l.refcon == fl.refcon;
+            });
+            if (it == flight_loops.end())
+                continue;   // unregistered by a previous callback
+
+            counters.flight_loop++;
+            float since = now - it->last;
+            it->last = now;
+            float ret = fl.cb(since, since, ++it->counter, fl.refcon);
+
+            // ret may have been unregistered by its own callback
+            it = std::find_if(flight_loops.begin(), flight_loops.end(), [&fl](const FlightLoop& l) {
+                return l.cb == fl.cb && l.refcon == fl.refcon;
+            });
+            if (it == flight_loops.end())
+                continue;
+
+            // > 0: seconds, < 0: frames, 0: deactivated
+            it->next = (ret > 0.0f) ? now + ret : (ret < 0.0f) ? now - ret * frame_time - frame_time / 2 : 0.0f;
+        }
+    }
+}
+
+Counters GetCounters() { return counters; }
+
+void Reset() {
+    for (auto& dr : drefs)
+        *dr.second = Dref();
+    widgets.clear();
+    flight_loops.clear();
+    actions.clear();
+    now = 0.0f;
+    counters = Counters();
+}
+
+}  // namespace xplm_stub
+
+//
+// the SDK
+//
+XPLMDataRef XPLMFindDataRef(const char *name) {
+    counters.find_dataref++;
+    auto it = drefs.find(name);
+    return (it != drefs.end() && it->second->present) ? it->second.get() : nullptr;
+}
+
+static const Dref& D(XPLMDataRef dr) {
+    static const Dref empty{};
+    counters.get_data++;
+    return dr ? *static_cast<const Dref *>(dr) : empty;
+}
+
+int XPLMGetDatai(XPLMDataRef dr) { return D(dr).i; }
+float XPLMGetDataf(XPLMDataRef dr) { return D(dr).f; }
+double XPLMGetDatad(XPLMDataRef dr) { return D(dr).d; }
+
+int XPLMGetDatavi(XPLMDataRef dr, int *values, int offset, int max) {
+    return GetArray(D(dr).vi, values, offset, max);
+}
+
+int XPLMGetDatavf(XPLMDataRef dr, float *values, int offset, int max) {
+    return GetArray(D(dr).vf, values, offset, max);
+}
+
+int XPLMGetDatab(XPLMDataRef dr, void *value, int offset, int max) {
+    const std::string& b = D(dr).b;
+    if (value == nullptr)
+        return b.size();
+
+    int n = std::clamp((int)b.size() - offset, 0, max);
+    if (n > 0)
+        memcpy(value, b.data() + offset, n);
+    return n;
+}
+
+void XPLMDebugString(const char *str) {
+    if (debug_out)
+        fputs(str, debug_out);
+}
+
+float XPLMGetElapsedTime() { return now; }
+
+void XPLMRegisterFlightLoopCallback(XPLMFlightLoop_f cb, float interval, void *refcon) {
+    XPLMUnregisterFlightLoopCallback(cb, refcon);
+    float next = (interval > 0.0f) ? now + interval : (interval < 0.0f) ? now : 0.0f;
+    flight_loops.push_back({cb, refcon, next, now, 0});
+}
+
+void XPLMUnregisterFlightLoopCallback(XPLMFlightLoop_f cb, void *refcon) {
+    flight_loops.erase(std::remove_if(flight_loops.begin(), flight_loops.end(),
+                                      [cb, refcon](const FlightLoop& fl) { return fl.cb == cb && fl.refcon == refcon; }),
+                       flight_loops.end());
+}
+
+void XPLMGetScreenBoundsGlobal(int *left, int *top, int *right, int *bottom) {
+    if (left)
+        *left = screen[0];
+    if (top)
+        *top = screen[1];
+    if (right)
+        *right = screen[2];
+    if (bottom)
+        *bottom = screen[3];
+}
+
+void XPLMSetWindowPositioningMode(XPLMWindowID window, XPLMWindowPositioningMode mode, int) {
+    GetWidget(window).window_mode = mode;  // the window of a widget is the widget
+}
+
+int XPIsWidgetVisible(XPWidgetID widget) { return GetWidget(widget).visible; }
+void XPShowWidget(XPWidgetID widget) { GetWidget(widget).visible = true; }
+void XPHideWidget(XPWidgetID widget) { GetWidget(widget).visible = false; }
+XPLMWindowID XPGetWidgetUnderlyingWindow(XPWidgetID widget) { return widget; }
+
+void XPSetWidgetGeometry(XPWidgetID widget, int left, int top, int right, int bottom) {
+    xplm_stub::Widget& w = GetWidget(widget);
+    w.left = left;
+    w.top = top;
+    w.right = right;
+    w.bottom = bottom;
+}
+
+void XPGetWidgetGeometry(XPWidgetID widget, int *left, int *top, int *right, int *bottom) {
+    const xplm_stub::Widget& w = GetWidget(widget);
+    if (left)
+        *left = w.left;
+    if (top)
+        *top = w.top;
+    if (right)
+        *right = w.right;
+    if (bottom)
+        *bottom = w.bottom;
+}
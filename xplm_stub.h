@@ -0,0 +1,97 @@
+//
+//    Copyright (C) 2026 Holger Teutsch
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 2.1 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+//    USA
+//
+
+#ifndef _XPLM_STUB_H_
+#define _XPLM_STUB_H_
+
+// Headless stand-in for the parts of the X-Plane SDK that xplib uses
+//
+// Link xplm_stub.o instead of the XPLM and XPWidgets libraries to run xplib code
+// outside of X-Plane, e.g. in test or benchmark binaries that can be profiled with perf.
+// Compile against the SDK headers as usual.
+//
+// xplm_stub::SetString("sbh/icao_airline", "DLH");     // create or set a dataref
+// xplm_stub::SetInt("sbh/seqno", 1);
+// xplm_stub::At(10.0f, [] { xplm_stub::SetInt("sbh/seqno", 2); });   // scripted change
+// xplm_stub::Run(60.0f);                                // 60 s of flight loops
+//
+// XPLMDebugString() writes to stdout, see SetDebugOutput(). Everything must be called from one thread,
+// as datarefs and flight loops in X-Plane.
+
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace xplm_stub {
+
+// Datarefs are created on the first Set*(), a value can be read as any of the types.
+void SetInt(const std::string& name, int val);
+void SetFloat(const std::string& name, float val);
+void SetDouble(const std::string& name, double val);
+void SetString(const std::string& name, const std::string& val);      // byte data
+void SetInts(const std::string& name, const std::vector<int>& val);
+void SetFloats(const std::string& name, const std::vector<float>& val);
+
+// XPLMFindDataRef() no longer finds it, e.g. of a plugin that is not loaded.
+// Handles found before read 0 or empty values.
+void Remove(const std::string& name);
+
+// display
+void SetScreenBounds(int left, int top, int right, int bottom);
+void SetVr(bool enabled);       // sim/graphics/VR/enabled
+
+// state of a widget (XPWidgetID) as set by the XPWidget calls, widgets exist on first use
+struct Widget {
+    bool visible;
+    int left, top, right, bottom;
+    int window_mode;            // of the underlying window, XPLMWindowPositioningMode
+};
+
+Widget GetWidget(void *widget);
+
+// where XPLMDebugString() writes to, nullptr discards, e.g. for timing loops that log
+void SetDebugOutput(FILE *f);
+
+// Simulated clock, XPLMGetElapsedTime()
+float Now();
+
+// run action when the clock reaches t
+void At(float t, std::function<void()> action);
+
+// Advance the clock by duration in frames of frame_time s. In each frame due actions
+// are run and then due flight loop callbacks are called.
+void Run(float duration, float frame_time = 1.0f / 30.0f);
+
+// # of SDK calls, e.g. to verify that a hot path does not query datarefs
+struct Counters {
+    unsigned find_dataref;
+    unsigned get_data;
+    unsigned widget;
+    unsigned flight_loop;
+};
+
+Counters GetCounters();
+
+// remove all datarefs, widgets, flight loops and actions, reset the clock and the counters
+void Reset();
+
+}  // namespace xplm_stub
+
+#endif
@@ -0,0 +1,174 @@
+//
+//    Copyright (C) 2026 Holger Teutsch
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU Lesser General Public
+//    License as published by the Free Software Foundation; either
+//    version 2.1 of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Lesser General Public License for more details.
+//
+//    You should have received a copy of the GNU Lesser General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+//    USA
+//
+
+// Runs the simbrief_hub and widget code against xplm_stub, see README for the build.
+//
+// ./xplm_stub_demo [iterations]
+//
+// Scripts an OFP and a CDM update through the sbh/* datarefs, delivers them to a
+// subscriber through the shared loader's flight loop and shows a widget in and out of VR.
+// Then times the hot paths; the stand-in is cheap enough that the numbers are those
+// of xplib, so the binary can be profiled with e.g. perf record.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "XPLMDisplay.h"
+#include "simbrief.h"
+#include "widget_ctx.h"
+#include "xplm_stub.h"
+
+const char *log_msg_prefix = "demo: ";
+
+static int failed;
+
+#define CHECK(cond)                                                       \
+    do {                                                                  \
+        if (!(cond)) {                                                    \
+            printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);      \
+            failed++;                                                     \
+        }                                                                 \
+    } while (0)
+
+static void SetOfp(int seqno, const char *flight_number, const char *est_out) {
+    xplm_stub::SetInt("sbh/seqno", seqno);
+    xplm_stub::SetString("sbh/icao_airline", "DLH");
+    xplm_stub::SetString("sbh/flight_number", flight_number);
+    xplm_stub::SetString("sbh/aircraft_icao", "A20N");
+    xplm_stub::SetString("sbh/destination", "EDDM");
+    xplm_stub::SetString("sbh/pax_count", "174");
+    xplm_stub::SetString("sbh/freight", "1200");
+    xplm_stub::SetString("sbh/est_out", est_out);
+    xplm_stub::SetString("sbh/est_off", "1700001200");
+    xplm_stub::SetString("sbh/est_on", "1700004800");
+    xplm_stub::SetString("sbh/est_in", "1700005400");
+    xplm_stub::SetString("sbh/dx_rmk", "");
+}
+
+static void SetCdm(int seqno, const char *tsat) {
+    xplm_stub::SetInt("sbh/cdm/seqno", seqno);
+    xplm_stub::SetString("sbh/cdm/tobt", "1155");
+    xplm_stub::SetString("sbh/cdm/tsat", tsat);
+    xplm_stub::SetString("sbh/cdm/ctot", "");
+    xplm_stub::SetString("sbh/cdm/runway", "25C");
+    xplm_stub::SetString("sbh/cdm/sid", "MARUN7F");
+}
+
+template <typename F>
+static double NsPerCall(int n, F&& f) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++)
+        f(i);
+    std::chrono::duration<double, std::nano> dt = std::chrono::steady_clock::now() - t0;
+    return dt.count() / n;
+}
+
+int main(int argc, char **argv) {
+    int n = (argc > 1) ? atoi(argv[1]) : 1000000;
+
+    xplm_stub::SetInt("sbh/stale", 0);
+    SetOfp(1, "456", "1700000000");
+    SetCdm(1, "1200");
+
+    // scripted updates while the flight loop runs
+    xplm_stub::At(10.0f, [] { SetOfp(2, "457", "1700000600"); });
+    xplm_stub::At(20.0f, [] { SetCdm(2, "1210"); });
+
+    int calls = 0;
+    unsigned all_changed = 0;
+    std::string dep_str;
+    OfpSubscription sub = OfpSubscribe(Ofp::kOfpGroup | Ofp::kCdmGroup,
+        [&](const std::shared_ptr<const Ofp>& ofp, unsigned changed) {
+            calls++;
+            all_changed |= changed;
+            dep_str = ofp->GenDepartureStr();
+            printf("t: %5.1f, changed: 0x%04x, '%s'\n", xplm_stub::Now(), changed, dep_str.c_str());
+        });
+
+    xplm_stub::Run(30.0f);
+    CHECK(calls == 3);
+    CHECK((all_changed & (Ofp::kFlightNumber | Ofp::kEstOut | Ofp::kCdmTsat)) ==
+          (Ofp::kFlightNumber | Ofp::kEstOut | Ofp::kCdmTsat));
+    CHECK(dep_str.find("457") != std::string::npos);
+
+    // a plugin that disappears is not fatal
+    OfpUnsubscribe(sub);
+    xplm_stub::Run(5.0f);
+    CHECK(calls == 3);
+
+    // a callback that tears down another subscriber and itself within the same tick
+    int first_calls = 0, second_calls = 0;
+    OfpSubscription first = 0, second = 0;
+    first = OfpSubscribe(Ofp::kOfpGroup, [&](const std::shared_ptr<const Ofp>&, unsigned) {
+        first_calls++;
+        OfpUnsubscribe(second);
+        OfpUnsubscribe(first);
+    });
+    second = OfpSubscribe(Ofp::kOfpGroup, [&](const std::shared_ptr<const Ofp>&, unsigned) { second_calls++; });
+    xplm_stub::Run(3.0f);
+    CHECK(first_calls == 1 && second_calls == 0);
+
+    // widget into VR and back
+    static int widget_id;   // any unique address will do
+    XPWidgetID widget = &widget_id;
+    WidgetCtx ctx;
+    xplm_stub::SetScreenBounds(0, 1440, 2560, 0);
+    xplm_stub::SetVr(false);
+    ctx.Set(widget, 100, 900, 400, 300);
+    ctx.Show();
+    xplm_stub::Widget w = xplm_stub::GetWidget(widget);
+    CHECK(w.visible && w.left == 100 && w.top == 900 && w.right == 500 && w.bottom == 600);
+
+    ctx.Hide();
+    xplm_stub::SetVr(true);
+    ctx.Show();
+    w = xplm_stub::GetWidget(widget);
+    CHECK(w.visible && w.window_mode == xplm_WindowVR);
+
+    // hot paths
+    xplm_stub::SetDebugOutput(nullptr);
+    Ofp ofp;
+    ofp.UpdateIfNewer();
+    xplm_stub::Counters c0 = xplm_stub::GetCounters();
+    double t_update = NsPerCall(n, [&](int) { ofp.UpdateIfNewer(); });
+    xplm_stub::Counters c1 = xplm_stub::GetCounters();
+    CHECK(c1.find_dataref == c0.find_dataref);
+
+    double t_load = NsPerCall(n / 10, [&](int) { Ofp::LoadIfNewer(0); });
+
+    char buf[128];
+    size_t len = 0;
+    double t_dep = NsPerCall(n, [&](int) { len += ofp.GenDepartureStr(buf, sizeof(buf)); });
+
+    xplm_stub::SetVr(false);
+    ctx.Hide();
+    double t_show = NsPerCall(n / 10, [&](int) { ctx.Show(); ctx.Hide(); });
+
+    printf("\n%d iterations\n", n);
+    printf("Ofp::UpdateIfNewer, unchanged:    %8.1f ns, %.1f dataref reads\n", t_update,
+           double(c1.get_data - c0.get_data) / n);
+    printf("Ofp::LoadIfNewer:                 %8.1f ns\n", t_load);
+    printf("Ofp::GenDepartureStr(buf, size):  %8.1f ns (%zu)\n", t_dep, len / n);
+    printf("WidgetCtx::Show + Hide:           %8.1f ns\n", t_show);
+
+    OfpSharedLoader().Stop();
+    printf("%s\n", failed ? "FAILED" : "OK");
+    return failed ? 1 : 0;
+}